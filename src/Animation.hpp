@@ -0,0 +1,177 @@
+#pragma once
+
+#include <cmath>
+#include <unordered_map>
+
+#include "TimeOperators.hpp"
+
+enum class Easing : uint8_t {
+    Linear,
+    InQuad,
+    OutQuad,
+    InOutQuad,
+    InCubic,
+    OutCubic,
+    InOutCubic
+};
+
+// Maps progress t in [0, 1] onto the curve; every curve starts at 0 and ends at 1.
+constexpr double ease(Easing curve, double t) {
+    switch(curve) {
+    case Easing::Linear: return t;
+    case Easing::InQuad: return t * t;
+    case Easing::OutQuad: return t * (2 - t);
+    case Easing::InOutQuad: return t < 0.5 ? 2 * t * t : -1 + (4 - 2 * t) * t;
+    case Easing::InCubic: return t * t * t;
+    case Easing::OutCubic: return (t - 1) * (t - 1) * (t - 1) + 1;
+    case Easing::InOutCubic: return t < 0.5 ? 4 * t * t * t : (t - 1) * (2 * t - 2) * (2 * t - 2) + 1;
+    }
+    return t;
+}
+
+template <class T>
+concept Animatable = std::is_arithmetic_v<T> && !std::is_same_v<T, bool>;
+
+// Animator advances every running animation in one pass per tick(). State is
+// kept as parallel arrays so the progress and interpolation loops run over
+// contiguous doubles, and all results are written inside one PropertyBatch:
+// a property depending on many animated ones is re-evaluated and observed
+// once per frame, however many animations are running.
+//
+// Animated properties must outlive their animation or be stop()ped first.
+class Animator {
+public:
+    explicit Animator(PropertyClock& clock) :
+        m_clock(clock), m_base(clock.now()) { }
+
+    Animator(const Animator&) = delete;
+    Animator& operator=(const Animator&) = delete;
+
+    // Animates from the current value; replaces a running animation of target.
+    template <Animatable T>
+    void animate(property<T>& target, T to, PropertyClock::duration duration, Easing curve = Easing::Linear) {
+        animate(target, target.value(), to, duration, curve);
+    }
+
+    template <Animatable T>
+    void animate(property<T>& target, T from, T to, PropertyClock::duration duration, Easing curve = Easing::Linear) {
+        if(duration <= PropertyClock::duration::zero()) {
+            stop(target);
+            target.setValue(to);
+            return;
+        }
+        size_t i;
+        if(auto it = m_index.find(&target); it != m_index.end()) {
+            i = it->second;
+        } else {
+            i = m_targets.size();
+            m_index.emplace(&target, i);
+            m_targets.push_back({&target, &apply<T>});
+            m_from.emplace_back();
+            m_delta.emplace_back();
+            m_start.emplace_back();
+            m_rate.emplace_back();
+            m_curve.emplace_back();
+            m_out.emplace_back();
+        }
+        m_from[i] = static_cast<double>(from);
+        m_delta[i] = static_cast<double>(to) - static_cast<double>(from);
+        m_start[i] = seconds(m_clock.now());
+        m_rate[i] = 1 / std::chrono::duration<double>(duration).count();
+        m_curve[i] = curve;
+    }
+
+    template <Animatable T>
+    bool stop(const property<T>& target) {
+        auto it = m_index.find(&target);
+        if(it == m_index.end())
+            return false;
+        remove(it->second);
+        return true;
+    }
+
+    template <Animatable T>
+    bool isAnimating(const property<T>& target) const { return m_index.contains(&target); }
+
+    size_t active() const { return m_targets.size(); }
+
+    void tick() { tick(m_clock.now()); }
+
+    // Writes the value of every animation at `now` and drops the finished ones.
+    void tick(PropertyClock::time_point now) {
+        size_t n = m_targets.size();
+        if(n == 0)
+            return;
+        double t = seconds(now);
+        for(size_t i = 0; i < n; ++i)
+            m_out[i] = std::clamp((t - m_start[i]) * m_rate[i], 0.0, 1.0);
+        bool finished = false;
+        for(size_t i = 0; i < n; ++i) {
+            finished |= m_out[i] >= 1.0;
+            m_out[i] = ease(m_curve[i], m_out[i]);
+        }
+        for(size_t i = 0; i < n; ++i)
+            m_out[i] = m_from[i] + m_delta[i] * m_out[i];
+        {
+            PropertyBatch batch;
+            for(size_t i = 0; i < n; ++i)
+                m_targets[i].apply(m_targets[i].property, m_out[i]);
+        }
+        if(!finished)
+            return;
+        // Observers run by the batch may have stopped or started animations.
+        for(size_t i = m_targets.size(); i-- > 0;) {
+            if((t - m_start[i]) * m_rate[i] >= 1.0)
+                remove(i);
+        }
+    }
+
+private:
+    struct Target {
+        void* property;
+        void (*apply)(void*, double);
+    };
+
+    double seconds(PropertyClock::time_point at) const { return std::chrono::duration<double>(at - m_base).count(); }
+
+    template <class T>
+    static void apply(void* p, double v) {
+        if constexpr(std::is_integral_v<T>)
+            static_cast<property<T>*>(p)->setValue(static_cast<T>(std::lround(v)));
+        else
+            static_cast<property<T>*>(p)->setValue(static_cast<T>(v));
+    }
+
+    // Swaps the last animation into slot i.
+    void remove(size_t i) {
+        size_t last = m_targets.size() - 1;
+        m_index.erase(m_targets[i].property);
+        if(i != last) {
+            m_targets[i] = m_targets[last];
+            m_from[i] = m_from[last];
+            m_delta[i] = m_delta[last];
+            m_start[i] = m_start[last];
+            m_rate[i] = m_rate[last];
+            m_curve[i] = m_curve[last];
+            m_index[m_targets[i].property] = i;
+        }
+        m_targets.pop_back();
+        m_from.pop_back();
+        m_delta.pop_back();
+        m_start.pop_back();
+        m_rate.pop_back();
+        m_curve.pop_back();
+        m_out.pop_back();
+    }
+
+    PropertyClock& m_clock;
+    PropertyClock::time_point m_base;
+    std::vector<Target> m_targets;
+    std::vector<double> m_from;
+    std::vector<double> m_delta;
+    std::vector<double> m_start; // seconds since m_base
+    std::vector<double> m_rate;  // 1 / duration in seconds
+    std::vector<Easing> m_curve;
+    std::vector<double> m_out;
+    std::unordered_map<const void*, size_t> m_index;
+};
@@ -0,0 +1,59 @@
+#pragma once
+
+#include "ListProperty.hpp"
+
+// ChangePoller lets a consumer running its own loop find out which of many
+// properties changed since an epoch it stored, with one integer compare per
+// property and no observers. Typical use:
+//
+//     uint64_t seen = ChangeEpoch::current();
+//     ... later, once per frame ...
+//     poller.forEachChanged(seen, [](size_t i) { redraw(i); });
+//     seen = ChangeEpoch::current();
+//
+// Properties are referenced, not owned; they must outlive the poller.
+class ChangePoller {
+public:
+    template <class T, bool W>
+    size_t add(const BasicProperty<T, W>& prop) { return add(prop.getBinder()); }
+
+    template <class T>
+    size_t add(const BasicList<T>& list) { return add(&list.binder); }
+
+    template <class K, class V, class C>
+    size_t add(const MapProperty<K, V, C>& map) { return add(&map.binder); }
+
+    size_t size() const { return m_notifiers.size(); }
+
+    bool changedSince(uint64_t epoch) const {
+        for(auto n : m_notifiers) {
+            if(n->version() > epoch)
+                return true;
+        }
+        return false;
+    }
+
+    // Calls f(index) for every property changed since epoch, index being the
+    // value add() returned for it.
+    template <std::invocable<size_t> F>
+    void forEachChanged(uint64_t epoch, F&& f) const {
+        for(size_t i = 0; i < m_notifiers.size(); ++i) {
+            if(m_notifiers[i]->version() > epoch)
+                f(i);
+        }
+    }
+
+    std::vector<size_t> changedSinceList(uint64_t epoch) const {
+        std::vector<size_t> out;
+        forEachChanged(epoch, [&out](size_t i) { out.push_back(i); });
+        return out;
+    }
+
+private:
+    size_t add(const BindingNotifier* notifier) {
+        m_notifiers.push_back(notifier);
+        return m_notifiers.size() - 1;
+    }
+
+    std::vector<const BindingNotifier*> m_notifiers;
+};
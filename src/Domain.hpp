@@ -0,0 +1,257 @@
+#pragma once
+
+#include <future>
+#include <optional>
+#include <thread>
+
+#include "Property.hpp"
+
+class DomainBinding;
+
+// A PropertyDomain is one partition of the binding graph, owned by a thread of
+// its own. The engine keeps its propagation state per thread, so properties
+// used only by a domain's thread propagate without locks, and independent
+// domains scale across cores. Versions come from the global ChangeEpoch, so a
+// ChangePoller on any thread can compare them.
+//
+// Everything else reaches a domain through a lock-free channel. post() queues
+// a task; bind() keeps a property of the domain following a property of another
+// domain. The domain thread drains the channel in flushes, in arrival order.
+// Each cross-domain binding delivers only the latest of the values sent since
+// the previous flush, and values arriving back to back are applied inside one
+// PropertyBatch, so their dependents update once. Tasks run outside batches:
+// their writes have propagated by the time they return.
+//
+// Properties belong to the domain that created them: create, use and destroy
+// them in tasks run by that domain. Destroy a domain after the domains that
+// send to it have stopped doing so.
+class PropertyDomain {
+public:
+    PropertyDomain() :
+        m_thread([this] { run(); }) { }
+
+    PropertyDomain(const PropertyDomain&) = delete;
+    PropertyDomain& operator=(const PropertyDomain&) = delete;
+
+    // Delivers what is still queued, then stops the thread.
+    ~PropertyDomain() {
+        post([this] { m_running = false; });
+        m_thread.join();
+    }
+
+    // The domain running the calling thread, if any.
+    static PropertyDomain* current() { return s_current; }
+
+    // Runs f on the domain thread at its next flush. Safe from any thread.
+    template <std::invocable F>
+    void post(F&& f) { push(new Task<std::decay_t<F>>(std::forward<F>(f))); }
+
+    // Runs f on the domain thread and waits for its result.
+    template <std::invocable F>
+    std::invoke_result_t<F> invoke(F&& f) {
+        if(s_current == this)
+            return f();
+        std::packaged_task<std::invoke_result_t<F>()> task(std::forward<F>(f));
+        auto result = task.get_future();
+        post([&task] { task(); });
+        return result.get();
+    }
+
+    uint64_t flushes() const { return m_flushes.load(std::memory_order_relaxed); }
+
+    // Keeps target, a property of this domain, equal to source, a property of
+    // from. Call on this domain's thread. The subscription to source is made
+    // on from's thread, so source must still be alive when from runs it; it
+    // lasts until the returned binding or source is destroyed.
+    template <class T, bool W>
+    [[nodiscard]] DomainBinding bind(property<T>& target, PropertyDomain& from, const BasicProperty<T, W>& source);
+
+private:
+    friend class DomainBinding;
+
+    struct Message {
+        Message* next = nullptr;
+        bool value = false;
+        virtual void deliver() = 0;
+
+    protected:
+        ~Message() = default;
+    };
+
+    template <class F>
+    struct Task final : Message {
+        explicit Task(F&& f) :
+            func(std::move(f)) { }
+        explicit Task(const F& f) :
+            func(f) { }
+
+        void deliver() override {
+            func();
+            delete this;
+        }
+
+        F func;
+    };
+
+    struct LinkBase : Message {
+        LinkBase() { value = true; }
+        virtual ~LinkBase() = default;
+        virtual void detach() = 0;
+    };
+
+    // The sending side writes the latest value into a slot and queues the
+    // link unless it is queued already; the domain thread takes the slot at
+    // delivery. Values overwritten in between are dropped, and their slots
+    // are recycled, so a steady stream of sends does not allocate.
+    template <class T>
+    class Link final : public LinkBase, public std::enable_shared_from_this<Link<T>> {
+    public:
+        Link(PropertyDomain& to, property<T>* target) :
+            m_to(to), m_target(target) { }
+
+        ~Link() {
+            delete m_latest.load();
+            delete m_spare.load();
+        }
+
+        // On the source's thread.
+        void send(const T& value) {
+            Slot* slot = m_spare.exchange(nullptr);
+            if(slot)
+                slot->value = value;
+            else
+                slot = new Slot{value};
+            if(Slot* old = m_latest.exchange(slot))
+                delete m_spare.exchange(old);
+            if(!m_queued.exchange(true)) {
+                m_keep = this->shared_from_this();
+                m_to.push(this);
+            }
+        }
+
+        // On the domain thread.
+        void deliver() override {
+            auto keep = std::move(m_keep);
+            m_queued.store(false);
+            Slot* slot = m_latest.exchange(nullptr);
+            if(!slot)
+                return;
+            if(m_target)
+                m_target->setValue(slot->value);
+            delete m_spare.exchange(slot);
+        }
+
+        void detach() override { m_target = nullptr; }
+
+    private:
+        struct Slot {
+            T value;
+        };
+
+        PropertyDomain& m_to;
+        property<T>* m_target;
+        std::atomic<Slot*> m_latest = nullptr;
+        std::atomic<Slot*> m_spare = nullptr;
+        std::atomic<bool> m_queued = false;
+        std::shared_ptr<Link> m_keep; // while queued
+    };
+
+    // Treiber stack: any thread pushes, the domain thread takes all at once,
+    // so nodes are never popped one by one and ABA cannot occur.
+    void push(Message* m) {
+        Message* head = m_head.load(std::memory_order_relaxed);
+        do
+            m->next = head;
+        while(!m_head.compare_exchange_weak(head, m, std::memory_order_release, std::memory_order_relaxed));
+        if(!head)
+            m_head.notify_one();
+    }
+
+    void run() {
+        s_current = this;
+        while(m_running) {
+            m_head.wait(nullptr, std::memory_order_acquire);
+            flush();
+        }
+        flush();
+        s_current = nullptr;
+    }
+
+    void flush() {
+        Message* m = m_head.exchange(nullptr, std::memory_order_acquire);
+        Message* ordered = nullptr;
+        while(m) {
+            Message* next = m->next;
+            m->next = ordered;
+            ordered = m;
+            m = next;
+        }
+        while(ordered) {
+            bool value = ordered->value;
+            std::optional<PropertyBatch> batch;
+            if(value)
+                batch.emplace();
+            while(ordered && ordered->value == value) {
+                Message* next = ordered->next;
+                ordered->deliver();
+                ordered = next;
+            }
+        }
+        m_flushes.fetch_add(1, std::memory_order_relaxed);
+    }
+
+    std::atomic<Message*> m_head = nullptr;
+    std::atomic<uint64_t> m_flushes = 0;
+    bool m_running = true; // domain thread only
+    std::thread m_thread;
+
+    inline static thread_local PropertyDomain* s_current = nullptr;
+};
+
+// Cuts a cross-domain binding when destroyed. Destroy it on the target's
+// domain thread.
+class DomainBinding {
+public:
+    DomainBinding() = default;
+    DomainBinding(DomainBinding&&) = default;
+
+    DomainBinding& operator=(DomainBinding&& other) {
+        reset();
+        m_link = std::move(other.m_link);
+        return *this;
+    }
+
+    ~DomainBinding() { reset(); }
+
+    void reset() {
+        if(m_link)
+            m_link->detach();
+        m_link.reset();
+    }
+
+    explicit operator bool() const { return m_link != nullptr; }
+
+private:
+    friend class PropertyDomain;
+
+    explicit DomainBinding(std::shared_ptr<PropertyDomain::LinkBase> link) :
+        m_link(std::move(link)) { }
+
+    std::shared_ptr<PropertyDomain::LinkBase> m_link;
+};
+
+template <class T, bool W>
+DomainBinding PropertyDomain::bind(property<T>& target, PropertyDomain& from, const BasicProperty<T, W>& source) {
+    auto link = std::make_shared<Link<T>>(*this, &target);
+    from.post([weak = std::weak_ptr<Link<T>>(link), &source] {
+        auto link = weak.lock();
+        if(!link)
+            return;
+        source.onValueChanged(std::weak_ptr<void>(weak), [weak](const T& value) {
+            if(auto link = weak.lock())
+                link->send(value);
+        });
+        link->send(source.value());
+    });
+    return DomainBinding(std::move(link));
+}
@@ -0,0 +1,90 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <sys/eventfd.h>
+#include <unistd.h>
+
+#include <deque>
+
+#include "Property.hpp"
+
+// PropertyEventSource exposes a set of properties as a file descriptor for
+// poll/epoll loops. The descriptor becomes readable when any watched property
+// changes and stays readable until drain(); a burst of changes between two
+// drains costs a single wakeup.
+//
+// Properties are written on their own thread as usual; fd() can be waited on
+// and drain() called from any one other thread. Watch everything before the
+// properties start changing on another thread.
+class PropertyEventSource {
+public:
+    PropertyEventSource() :
+        m_fd(eventfd(0, EFD_NONBLOCK | EFD_CLOEXEC)) { }
+
+    PropertyEventSource(const PropertyEventSource&) = delete;
+    PropertyEventSource& operator=(const PropertyEventSource&) = delete;
+
+    ~PropertyEventSource() {
+        m_context.reset();
+        if(m_fd >= 0)
+            close(m_fd);
+    }
+
+    explicit operator bool() const { return m_fd >= 0; }
+
+    int fd() const { return m_fd; }
+
+    size_t size() const { return m_slots.size(); }
+
+    // Returns the index drain() reports for prop.
+    template <class T, bool W>
+    size_t watch(const BasicProperty<T, W>& prop) {
+        size_t i = m_slots.size();
+        std::atomic<bool>* changed = &m_slots.emplace_back(false);
+        prop.onValueChanged(m_context, [this, changed] {
+            changed->store(true, std::memory_order_relaxed);
+            if(!m_armed.exchange(true, std::memory_order_acq_rel))
+                signal();
+        });
+        return i;
+    }
+
+    // Calls f(index) for every property changed since the previous drain and
+    // returns how many there were. Never blocks.
+    template <std::invocable<size_t> F>
+    size_t drain(F&& f) {
+        uint64_t count;
+        if(read(m_fd, &count, sizeof(count)) < 0 && !m_armed.load(std::memory_order_acquire))
+            return 0;
+        // Disarmed before the scan: a change landing during the scan signals
+        // again instead of being lost. The exchange reads the arming writer's
+        // release, so the scan sees every flag set before it.
+        m_armed.exchange(false, std::memory_order_acq_rel);
+        size_t n = 0;
+        for(size_t i = 0; i < m_slots.size(); ++i) {
+            if(m_slots[i].exchange(false, std::memory_order_acq_rel)) {
+                f(i);
+                ++n;
+            }
+        }
+        return n;
+    }
+
+    size_t drain(std::vector<size_t>& changed) {
+        return drain([&changed](size_t i) { changed.push_back(i); });
+    }
+
+private:
+    void signal() {
+        uint64_t one = 1;
+        [[maybe_unused]] auto r = write(m_fd, &one, sizeof(one));
+    }
+
+    int m_fd;
+    std::atomic<bool> m_armed = false;
+    std::deque<std::atomic<bool>> m_slots; // grows without moving the flags observers point to
+    BindingContext m_context;
+};
+
+#endif
@@ -0,0 +1,436 @@
+#pragma once
+
+#include <unordered_map>
+
+#include "Item.h"
+
+enum class Edge : uint8_t {
+    Left,
+    Right,
+    HorizontalCenter,
+    Top,
+    Bottom,
+    VerticalCenter
+};
+
+template <class G>
+concept Geometry = requires(G g) {
+    { g.x } -> std::same_as<property<int>&>;
+    { g.y } -> std::same_as<property<int>&>;
+    { g.width } -> std::same_as<property<int>&>;
+    { g.height } -> std::same_as<property<int>&>;
+};
+
+// LayoutEngine positions Items (or anything with x/y/width/height) from anchors
+// and row/column/grid containers. Instead of one binding per geometry property,
+// every driven value is a flat linear constraint over slots (four per item plus
+// helper slots for grids), sorted once into dependency order when the layout
+// structure changes. solve(), called once per frame, re-reads only the inputs
+// that changed since the last frame, walks the order from the first dirty
+// constraint evaluating those with a dirty source, and writes the values that
+// moved inside one PropertyBatch.
+//
+// Items must outlive the engine; the engine must not move.
+class LayoutEngine {
+public:
+    struct Options {
+        int spacing = 0;
+        int padding = 0;
+        bool fit = true; // size the container to its content
+    };
+
+    LayoutEngine() = default;
+    LayoutEngine(const LayoutEngine&) = delete;
+    LayoutEngine& operator=(const LayoutEngine&) = delete;
+
+    template <Geometry G>
+    void add(G& item) { node(item); }
+
+    // Anchors an edge of item to an edge of target on the same axis.
+    template <Geometry A, Geometry B>
+    bool anchor(A& item, Edge edge, B& target, Edge targetEdge, int margin = 0) {
+        if(axis(edge) != axis(targetEdge))
+            return false;
+        uint32_t n = node(item);
+        m_nodes[n].anchors[static_cast<int>(edge)] = Anchor{node(target), targetEdge, margin};
+        m_rebuild = true;
+        return true;
+    }
+
+    template <Geometry A, Geometry B>
+    void fill(A& item, B& target, int margin = 0) {
+        anchor(item, Edge::Left, target, Edge::Left, margin);
+        anchor(item, Edge::Right, target, Edge::Right, margin);
+        anchor(item, Edge::Top, target, Edge::Top, margin);
+        anchor(item, Edge::Bottom, target, Edge::Bottom, margin);
+    }
+
+    template <Geometry A, Geometry B>
+    void centerIn(A& item, B& target) {
+        anchor(item, Edge::HorizontalCenter, target, Edge::HorizontalCenter);
+        anchor(item, Edge::VerticalCenter, target, Edge::VerticalCenter);
+    }
+
+    template <Geometry C, Geometry... Children>
+    void row(C& container, Options options, Children&... children) {
+        addContainer(Container::Row, 0, container, options, children...);
+    }
+
+    template <Geometry C, Geometry... Children>
+    void column(C& container, Options options, Children&... children) {
+        addContainer(Container::Column, 0, container, options, children...);
+    }
+
+    template <Geometry C, Geometry... Children>
+    void grid(C& container, uint32_t columns, Options options, Children&... children) {
+        addContainer(Container::Grid, std::max(columns, 1u), container, options, children...);
+    }
+
+    // Brings every driven property up to date. Returns false, and writes
+    // nothing, if the constraints form a cycle.
+    bool solve() {
+        if(m_rebuild && !rebuild())
+            return false;
+        size_t from = m_order.size();
+        for(uint32_t slot : m_pending) {
+            m_queued[slot] = false;
+            if(m_driver[slot] >= 0)
+                continue;
+            int v = m_props[slot]->value();
+            if(v != m_values[slot] || m_all) {
+                m_values[slot] = v;
+                markDirty(slot);
+                for(uint32_t c : m_readers[slot])
+                    from = std::min<size_t>(from, m_position[c]);
+            }
+        }
+        m_pending.clear();
+        if(m_all)
+            from = 0;
+        m_all = false;
+
+        m_evaluated = 0;
+        for(size_t i = from; i < m_order.size(); ++i) {
+            const Constraint& c = m_constraints[m_order[i]];
+            if(!anyDirty(c))
+                continue;
+            ++m_evaluated;
+            int v = evaluate(c);
+            if(v != m_values[c.dst]) {
+                m_values[c.dst] = v;
+                markDirty(c.dst);
+                if(c.dst < m_props.size())
+                    m_changed.push_back(c.dst);
+            }
+        }
+        for(uint32_t slot : m_dirtyList)
+            m_dirty[slot] = false;
+        m_dirtyList.clear();
+
+        m_writing = true;
+        {
+            PropertyBatch batch;
+            for(uint32_t slot : m_changed)
+                m_props[slot]->setValue(m_values[slot]);
+        }
+        m_writing = false;
+        m_changed.clear();
+        return true;
+    }
+
+    // Constraints evaluated by the last solve().
+    size_t evaluated() const { return m_evaluated; }
+    size_t constraints() const { return m_constraints.size(); }
+
+private:
+    enum Field : uint32_t { X, Y, Width, Height };
+
+    struct Anchor {
+        uint32_t target;
+        Edge edge;
+        int margin;
+    };
+
+    struct Node {
+        std::optional<Anchor> anchors[6];
+    };
+
+    enum class Container : uint8_t { Row, Column, Grid };
+
+    struct ContainerDesc {
+        Container kind;
+        uint32_t columns;
+        uint32_t node;
+        Options options;
+        std::vector<uint32_t> children;
+    };
+
+    struct Term {
+        uint32_t slot;
+        int coeff;
+    };
+
+    // dst = sum(coeff * value) / divisor + offset, or max(coeff * value) + offset
+    struct Constraint {
+        uint32_t dst;
+        uint32_t first;
+        uint32_t count;
+        bool max;
+        int divisor;
+        int offset;
+    };
+
+    static int axis(Edge e) { return static_cast<int>(e) / 3; }
+
+    static uint32_t slot(uint32_t node, Field f) { return node * 4 + f; }
+
+    template <Geometry G>
+    uint32_t node(G& item) {
+        auto [it, inserted] = m_index.try_emplace(&item.x, static_cast<uint32_t>(m_nodes.size()));
+        if(!inserted)
+            return it->second;
+        uint32_t n = it->second;
+        m_nodes.emplace_back();
+        m_values.resize(m_props.size()); // drop helper slots, rebuilt below
+        for(property<int>* p : {&item.x, &item.y, &item.width, &item.height}) {
+            uint32_t s = static_cast<uint32_t>(m_props.size());
+            m_props.push_back(p);
+            m_values.push_back(p->value());
+            m_queued.push_back(false);
+            p->onValueChanged(m_context, [this, s] { queue(s); });
+        }
+        m_rebuild = true;
+        return n;
+    }
+
+    template <Geometry C, Geometry... Children>
+    void addContainer(Container kind, uint32_t columns, C& container, Options options, Children&... children) {
+        ContainerDesc desc{kind, columns, node(container), options, {}};
+        (desc.children.push_back(node(children)), ...);
+        m_containers.push_back(std::move(desc));
+        m_rebuild = true;
+    }
+
+    void queue(uint32_t s) {
+        if(m_writing || m_queued[s])
+            return;
+        m_queued[s] = true;
+        m_pending.push_back(s);
+    }
+
+    void markDirty(uint32_t s) {
+        if(!m_dirty[s]) {
+            m_dirty[s] = true;
+            m_dirtyList.push_back(s);
+        }
+    }
+
+    bool anyDirty(const Constraint& c) const {
+        for(uint32_t i = c.first; i < c.first + c.count; ++i) {
+            if(m_dirty[m_terms[i].slot])
+                return true;
+        }
+        return false;
+    }
+
+    int evaluate(const Constraint& c) const {
+        int v = c.max ? std::numeric_limits<int>::min() : 0;
+        for(uint32_t i = c.first; i < c.first + c.count; ++i) {
+            int t = m_terms[i].coeff * m_values[m_terms[i].slot];
+            v = c.max ? std::max(v, t) : v + t;
+        }
+        if(c.max && c.count == 0)
+            v = 0;
+        return (c.max ? v : v / c.divisor) + c.offset;
+    }
+
+    uint32_t addSlot() {
+        m_values.push_back(0);
+        return static_cast<uint32_t>(m_values.size() - 1);
+    }
+
+    void set(uint32_t dst, std::span<const Term> terms, int offset, int divisor = 1, bool max = false) {
+        m_constraints.push_back({dst, static_cast<uint32_t>(m_terms.size()), static_cast<uint32_t>(terms.size()), max, divisor, offset});
+        m_terms.insert(m_terms.end(), terms.begin(), terms.end());
+    }
+
+    void set(uint32_t dst, std::initializer_list<Term> terms, int offset) { set(dst, std::span(terms.begin(), terms.size()), offset); }
+
+    // Twice the coordinate of an edge, so centers stay integral until the end.
+    void edgeTerms(std::vector<Term>& out, uint32_t n, Edge e, int sign) const {
+        Field pos = axis(e) == 0 ? X : Y;
+        Field size = axis(e) == 0 ? Width : Height;
+        int kind = static_cast<int>(e) % 3;
+        out.push_back({slot(n, pos), 2 * sign});
+        if(kind == 1)
+            out.push_back({slot(n, size), 2 * sign});
+        else if(kind == 2)
+            out.push_back({slot(n, size), sign});
+    }
+
+    void anchorAxis(uint32_t n, int ax) {
+        const auto& start = m_nodes[n].anchors[ax * 3];
+        const auto& end = m_nodes[n].anchors[ax * 3 + 1];
+        const auto& center = m_nodes[n].anchors[ax * 3 + 2];
+        uint32_t pos = slot(n, ax == 0 ? X : Y);
+        uint32_t size = slot(n, ax == 0 ? Width : Height);
+        std::vector<Term> terms;
+        if(start) {
+            edgeTerms(terms, start->target, start->edge, 1);
+            set(pos, terms, start->margin, 2);
+            if(end) {
+                // size = end edge - start edge - both margins
+                terms.clear();
+                edgeTerms(terms, end->target, end->edge, 1);
+                edgeTerms(terms, start->target, start->edge, -1);
+                set(size, terms, -end->margin - start->margin, 2);
+            }
+        } else if(end) {
+            edgeTerms(terms, end->target, end->edge, 1);
+            terms.push_back({size, -2});
+            set(pos, terms, -end->margin, 2);
+        } else if(center) {
+            edgeTerms(terms, center->target, center->edge, 1);
+            terms.push_back({size, -1});
+            set(pos, terms, center->margin, 2);
+        }
+    }
+
+    void layoutContainer(const ContainerDesc& d) {
+        const Options& o = d.options;
+        uint32_t c = d.node;
+        size_t count = d.children.size();
+        if(count == 0)
+            return;
+        if(d.kind == Container::Grid) {
+            uint32_t cols = static_cast<uint32_t>(std::min<size_t>(d.columns, count));
+            uint32_t rows = static_cast<uint32_t>((count + d.columns - 1) / d.columns);
+            uint32_t cellW = addSlot();
+            uint32_t cellH = addSlot();
+            std::vector<Term> widths, heights;
+            for(uint32_t child : d.children) {
+                widths.push_back({slot(child, Width), 1});
+                heights.push_back({slot(child, Height), 1});
+            }
+            set(cellW, widths, 0, 1, true);
+            set(cellH, heights, 0, 1, true);
+            for(size_t i = 0; i < count; ++i) {
+                int col = static_cast<int>(i % d.columns), row = static_cast<int>(i / d.columns);
+                set(slot(d.children[i], X), {{slot(c, X), 1}, {cellW, col}}, o.padding + col * o.spacing);
+                set(slot(d.children[i], Y), {{slot(c, Y), 1}, {cellH, row}}, o.padding + row * o.spacing);
+            }
+            if(o.fit) {
+                set(slot(c, Width), {{cellW, static_cast<int>(cols)}}, 2 * o.padding + static_cast<int>(cols - 1) * o.spacing);
+                set(slot(c, Height), {{cellH, static_cast<int>(rows)}}, 2 * o.padding + static_cast<int>(rows - 1) * o.spacing);
+            }
+            return;
+        }
+
+        bool row = d.kind == Container::Row;
+        Field pos = row ? X : Y, cross = row ? Y : X;
+        Field size = row ? Width : Height, crossSize = row ? Height : Width;
+        for(size_t i = 0; i < count; ++i) {
+            uint32_t child = d.children[i];
+            if(i == 0)
+                set(slot(child, pos), {{slot(c, pos), 1}}, o.padding);
+            else
+                set(slot(child, pos), {{slot(d.children[i - 1], pos), 1}, {slot(d.children[i - 1], size), 1}}, o.spacing);
+            set(slot(child, cross), {{slot(c, cross), 1}}, o.padding);
+        }
+        if(o.fit) {
+            uint32_t last = d.children.back();
+            set(slot(c, size), {{slot(last, pos), 1}, {slot(last, size), 1}, {slot(c, pos), -1}}, o.padding);
+            std::vector<Term> extents;
+            for(uint32_t child : d.children)
+                extents.push_back({slot(child, crossSize), 1});
+            set(slot(c, crossSize), extents, 2 * o.padding, 1, true);
+        }
+    }
+
+    bool rebuild() {
+        m_constraints.clear();
+        m_terms.clear();
+        m_values.resize(m_props.size());
+        for(uint32_t n = 0; n < m_nodes.size(); ++n) {
+            anchorAxis(n, 0);
+            anchorAxis(n, 1);
+        }
+        for(const auto& d : m_containers)
+            layoutContainer(d);
+
+        // The last constraint on a slot wins, so containers override anchors.
+        size_t slots = m_values.size();
+        m_driver.assign(slots, -1);
+        for(size_t i = 0; i < m_constraints.size(); ++i)
+            m_driver[m_constraints[i].dst] = static_cast<int>(i);
+
+        m_readers.assign(slots, {});
+        std::vector<uint32_t> indegree(m_constraints.size(), 0);
+        for(size_t i = 0; i < m_constraints.size(); ++i) {
+            const Constraint& c = m_constraints[i];
+            if(m_driver[c.dst] != static_cast<int>(i))
+                continue;
+            for(uint32_t t = c.first; t < c.first + c.count; ++t) {
+                m_readers[m_terms[t].slot].push_back(static_cast<uint32_t>(i));
+                if(m_driver[m_terms[t].slot] >= 0)
+                    ++indegree[i];
+            }
+        }
+
+        m_order.clear();
+        for(size_t i = 0; i < m_constraints.size(); ++i) {
+            if(m_driver[m_constraints[i].dst] == static_cast<int>(i) && indegree[i] == 0)
+                m_order.push_back(static_cast<uint32_t>(i));
+        }
+        for(size_t k = 0; k < m_order.size(); ++k) {
+            for(uint32_t r : m_readers[m_constraints[m_order[k]].dst]) {
+                if(--indegree[r] == 0)
+                    m_order.push_back(r);
+            }
+        }
+        size_t live = 0;
+        for(size_t i = 0; i < m_constraints.size(); ++i)
+            live += m_driver[m_constraints[i].dst] == static_cast<int>(i);
+        if(m_order.size() != live) {
+            m_order.clear();
+            return false;
+        }
+
+        m_position.assign(m_constraints.size(), 0);
+        for(size_t k = 0; k < m_order.size(); ++k)
+            m_position[m_order[k]] = static_cast<uint32_t>(k);
+        m_dirty.assign(slots, false);
+        m_dirtyList.clear();
+        for(uint32_t s = 0; s < m_props.size(); ++s)
+            queue(s);
+        m_all = true;
+        m_rebuild = false;
+        return true;
+    }
+
+    std::vector<Node> m_nodes;
+    std::vector<ContainerDesc> m_containers;
+    std::unordered_map<const void*, uint32_t> m_index;
+
+    // per slot; item slots come first and are the only ones with a property
+    std::vector<property<int>*> m_props;
+    std::vector<int> m_values;
+    std::vector<int> m_driver; // constraint index, -1 for inputs
+    std::vector<std::vector<uint32_t>> m_readers;
+    std::vector<bool> m_dirty;
+    std::vector<bool> m_queued;
+
+    std::vector<Constraint> m_constraints;
+    std::vector<Term> m_terms;
+    std::vector<uint32_t> m_order;    // constraint indices, dependencies first
+    std::vector<uint32_t> m_position; // constraint index -> position in m_order
+
+    std::vector<uint32_t> m_pending;
+    std::vector<uint32_t> m_dirtyList;
+    std::vector<uint32_t> m_changed;
+    size_t m_evaluated = 0;
+    bool m_rebuild = false;
+    bool m_all = false;
+    bool m_writing = false;
+    BindingContext m_context; // declared last: observers go before the queues they write
+};
@@ -0,0 +1,560 @@
+#pragma once
+
+#include <algorithm>
+#include <map>
+
+#include "Property.hpp"
+
+enum class ChangeKind {
+    Insert,
+    Erase,
+    Update,
+    Reset
+};
+
+// A contiguous range of rows touched by one mutation. Indices refer to the list
+// as it is after Insert/Update and as it was before Erase.
+struct ListChange {
+    ChangeKind kind;
+    size_t first = 0;
+    size_t count = 0;
+};
+
+// key is null for Reset.
+template <class K>
+struct MapChange {
+    ChangeKind kind;
+    const K* key = nullptr;
+};
+
+// BasicList is the read side shared by list_property and the derived views.
+// Observers registered with onListChanged receive every change as a diff, right
+// away and even inside a PropertyBatch; onValueChanged observers are fired
+// through the usual BindingNotifier.
+template <class T>
+class BasicList {
+    friend class ChangePoller;
+
+public:
+    using ValueType = T;
+    using Container = std::vector<T>;
+
+    BasicList() = default;
+    BasicList(const BasicList&) = delete;
+    BasicList& operator=(const BasicList&) = delete;
+
+    // Reads are recorded by a DependencyTracker; end() is not, begin() is.
+    const Container& value() const { return track(m_items); }
+    uint64_t version() const { return binder.version(); }
+    size_t size() const { return track(m_items).size(); }
+    bool empty() const { return track(m_items).empty(); }
+    const T& operator[](size_t i) const { return track(m_items)[i]; }
+    const T& at(size_t i) const { return track(m_items).at(i); }
+    auto begin() const { return track(m_items).begin(); }
+    auto end() const { return m_items.end(); }
+
+    template <std::invocable<const ListChange&> F>
+    void onListChanged(F&& f) {
+        m_diffs.addObserver(diff(std::forward<F>(f)));
+    }
+
+    // The observer is dropped on the first change after context expires.
+    template <std::invocable<const ListChange&> F>
+    void onListChanged(const std::weak_ptr<void>& context, F&& f) {
+        m_diffs.addObserver(context, diff(std::forward<F>(f)));
+    }
+
+    // The observer is removed eagerly when the context is reset or destroyed.
+    template <std::invocable<const ListChange&> F>
+    void onListChanged(const BindingContext& context, F&& f) {
+        m_diffs.addObserver(context, diff(std::forward<F>(f)));
+    }
+
+    template <std::invocable<const ListChange&> F>
+    Connection connectListChanged(F&& f) {
+        return m_diffs.connect(diff(std::forward<F>(f)));
+    }
+
+    template <std::invocable F>
+    void onValueChanged(F&& f) {
+        binder.addObserver(std::forward<F>(f));
+    }
+
+protected:
+    void emit(const ListChange& change) {
+        const ListChange* outer = std::exchange(m_change, &change);
+        m_diffs.fire(ObserverPriority::Normal);
+        m_change = outer;
+        binder.notify();
+    }
+
+    Container m_items;
+
+private:
+    const Container& track(const Container& items) const {
+        DependencyTracker::record(&binder);
+        return items;
+    }
+
+    template <class F>
+    auto diff(F&& f) {
+        return [this, func = std::forward<F>(f)] { func(*m_change); };
+    }
+
+    mutable BindingNotifier binder;
+    // Diff observers, fired by emit() directly rather than by a wave, so that
+    // every change reaches them while m_change points at it.
+    BindingNotifier m_diffs;
+    const ListChange* m_change = nullptr;
+};
+
+template <class T>
+class ListProperty : public BasicList<T> {
+    using BasicList<T>::m_items;
+    using BasicList<T>::emit;
+
+public:
+    ListProperty() = default;
+
+    ListProperty(std::vector<T> items) { m_items = std::move(items); }
+
+    ListProperty(std::initializer_list<T> items) { m_items = items; }
+
+    ListProperty& operator=(std::vector<T> items) {
+        assign(std::move(items));
+        return *this;
+    }
+
+    void assign(std::vector<T> items) {
+        m_items = std::move(items);
+        emit({ChangeKind::Reset, 0, m_items.size()});
+    }
+
+    template <class U>
+    requires std::constructible_from<T, U&&>
+    void push_back(U&& v) {
+        m_items.emplace_back(std::forward<U>(v));
+        emit({ChangeKind::Insert, m_items.size() - 1, 1});
+    }
+
+    template <class... Args>
+    T& emplace_back(Args&&... args) {
+        T& ref = m_items.emplace_back(std::forward<Args>(args)...);
+        emit({ChangeKind::Insert, m_items.size() - 1, 1});
+        return ref;
+    }
+
+    template <class U>
+    requires std::constructible_from<T, U&&>
+    void insert(size_t pos, U&& v) {
+        m_items.emplace(m_items.begin() + pos, std::forward<U>(v));
+        emit({ChangeKind::Insert, pos, 1});
+    }
+
+    template <std::input_iterator It>
+    void insert(size_t pos, It first, It last) {
+        size_t before = m_items.size();
+        m_items.insert(m_items.begin() + pos, first, last);
+        if(size_t n = m_items.size() - before)
+            emit({ChangeKind::Insert, pos, n});
+    }
+
+    // Rows past the end are ignored.
+    void erase(size_t pos, size_t count = 1) {
+        if(pos >= m_items.size())
+            return;
+        count = std::min(count, m_items.size() - pos);
+        if(count == 0)
+            return;
+        m_items.erase(m_items.begin() + pos, m_items.begin() + pos + count);
+        emit({ChangeKind::Erase, pos, count});
+    }
+
+    void pop_back() {
+        if(!m_items.empty())
+            erase(m_items.size() - 1);
+    }
+
+    void clear() { erase(0, m_items.size()); }
+
+    template <class U>
+    requires std::assignable_from<T&, U&&>
+    void set(size_t i, U&& v) {
+        m_items[i] = std::forward<U>(v);
+        emit({ChangeKind::Update, i, 1});
+    }
+
+    // Mutate one row in place; observers see a single Update of that row.
+    template <std::invocable<T&> F>
+    void modify(size_t i, F&& f) {
+        std::forward<F>(f)(m_items[i]);
+        emit({ChangeKind::Update, i, 1});
+    }
+};
+
+template <class T>
+using list_property = ListProperty<T>;
+
+template <class K, class V, class Compare = std::less<K>>
+class MapProperty {
+    friend class ChangePoller;
+
+public:
+    using KeyType = K;
+    using ValueType = V;
+    using Container = std::map<K, V, Compare>;
+
+    MapProperty() = default;
+    MapProperty(std::initializer_list<typename Container::value_type> items) :
+        m_items(items) { }
+    MapProperty(const MapProperty&) = delete;
+    MapProperty& operator=(const MapProperty&) = delete;
+
+    const Container& value() const { return track(m_items); }
+    uint64_t version() const { return binder.version(); }
+    size_t size() const { return track(m_items).size(); }
+    bool empty() const { return track(m_items).empty(); }
+    bool contains(const K& key) const { return track(m_items).contains(key); }
+    const V& at(const K& key) const { return track(m_items).at(key); }
+    auto find(const K& key) const { return track(m_items).find(key); }
+    auto begin() const { return track(m_items).begin(); }
+    auto end() const { return m_items.end(); }
+
+    void assign(Container items) {
+        m_items = std::move(items);
+        emit({ChangeKind::Reset});
+    }
+
+    template <class U>
+    requires std::assignable_from<V&, U&&>
+    void set(const K& key, U&& v) {
+        auto [it, inserted] = m_items.insert_or_assign(key, std::forward<U>(v));
+        emit({inserted ? ChangeKind::Insert : ChangeKind::Update, &it->first});
+    }
+
+    template <std::invocable<V&> F>
+    bool modify(const K& key, F&& f) {
+        auto it = m_items.find(key);
+        if(it == m_items.end())
+            return false;
+        std::forward<F>(f)(it->second);
+        emit({ChangeKind::Update, &it->first});
+        return true;
+    }
+
+    bool erase(const K& key) {
+        auto it = m_items.find(key);
+        if(it == m_items.end())
+            return false;
+        // Observers still see the key, the node is released afterwards.
+        auto node = m_items.extract(it);
+        emit({ChangeKind::Erase, &node.key()});
+        return true;
+    }
+
+    void clear() {
+        if(m_items.empty())
+            return;
+        m_items.clear();
+        emit({ChangeKind::Reset});
+    }
+
+    template <std::invocable<const MapChange<K>&> F>
+    void onMapChanged(F&& f) {
+        m_mapObservers.push_back([func = std::forward<F>(f)](const MapChange<K>& c) {
+            func(c);
+            return false;
+        });
+    }
+
+    template <std::invocable<const MapChange<K>&> F>
+    void onMapChanged(std::weak_ptr<void> context, F&& f) {
+        m_mapObservers.push_back([context = std::move(context), func = std::forward<F>(f)](const MapChange<K>& c) {
+            if(context.expired())
+                return true;
+            func(c);
+            return false;
+        });
+    }
+
+    template <std::invocable F>
+    void onValueChanged(F&& f) {
+        binder.addObserver(std::forward<F>(f));
+    }
+
+private:
+    void emit(const MapChange<K>& change) {
+        std::erase_if(m_mapObservers, [&change](std::function<bool(const MapChange<K>&)>& func) -> bool {
+            return func(change);
+        });
+        binder.notify();
+    }
+
+    const Container& track(const Container& items) const {
+        DependencyTracker::record(&binder);
+        return items;
+    }
+
+    Container m_items;
+    mutable BindingNotifier binder;
+    std::list<std::function<bool(const MapChange<K>&)>> m_mapObservers;
+};
+
+template <class K, class V, class Compare = std::less<K>>
+using map_property = MapProperty<K, V, Compare>;
+
+// ---------- derived views -------------
+// Views keep their own rows and translate each source diff into diffs of their own,
+// so a single-row change in the source costs one row of work downstream.
+
+template <class T, class Pred>
+class FilteredList : public BasicList<T> {
+    using BasicList<T>::m_items;
+    using BasicList<T>::emit;
+
+public:
+    FilteredList(const BasicList<T>& source, Pred pred) :
+        m_source(&source), m_pred(std::move(pred)) {
+        rebuild();
+        const_cast<BasicList<T>&>(source).onListChanged(m_context, [this](const ListChange& c) { onSourceChanged(c); });
+    }
+
+    // Index in the source list of the given row of this view.
+    size_t sourceIndex(size_t row) const { return m_rows[row]; }
+
+private:
+    void rebuild() {
+        m_rows.clear();
+        m_items.clear();
+        const auto& src = m_source->value();
+        for(size_t i = 0; i < src.size(); ++i) {
+            if(m_pred(src[i])) {
+                m_rows.push_back(i);
+                m_items.push_back(src[i]);
+            }
+        }
+    }
+
+    size_t rowOf(size_t sourceIndex) const {
+        return std::lower_bound(m_rows.begin(), m_rows.end(), sourceIndex) - m_rows.begin();
+    }
+
+    void onSourceChanged(const ListChange& c) {
+        const auto& src = m_source->value();
+        switch(c.kind) {
+        case ChangeKind::Insert: {
+            size_t row = rowOf(c.first);
+            for(size_t r = row; r < m_rows.size(); ++r)
+                m_rows[r] += c.count;
+            size_t n = 0;
+            for(size_t i = c.first; i < c.first + c.count; ++i) {
+                if(m_pred(src[i])) {
+                    m_rows.insert(m_rows.begin() + row + n, i);
+                    m_items.insert(m_items.begin() + row + n, src[i]);
+                    ++n;
+                }
+            }
+            if(n)
+                emit({ChangeKind::Insert, row, n});
+            break;
+        }
+        case ChangeKind::Erase: {
+            size_t lo = rowOf(c.first);
+            size_t hi = rowOf(c.first + c.count);
+            for(size_t r = hi; r < m_rows.size(); ++r)
+                m_rows[r] -= c.count;
+            if(hi > lo) {
+                m_rows.erase(m_rows.begin() + lo, m_rows.begin() + hi);
+                m_items.erase(m_items.begin() + lo, m_items.begin() + hi);
+                emit({ChangeKind::Erase, lo, hi - lo});
+            }
+            break;
+        }
+        case ChangeKind::Update:
+            for(size_t i = c.first; i < c.first + c.count; ++i) {
+                size_t row = rowOf(i);
+                bool present = row < m_rows.size() && m_rows[row] == i;
+                bool pass = m_pred(src[i]);
+                if(present && pass) {
+                    m_items[row] = src[i];
+                    emit({ChangeKind::Update, row, 1});
+                } else if(present) {
+                    m_rows.erase(m_rows.begin() + row);
+                    m_items.erase(m_items.begin() + row);
+                    emit({ChangeKind::Erase, row, 1});
+                } else if(pass) {
+                    m_rows.insert(m_rows.begin() + row, i);
+                    m_items.insert(m_items.begin() + row, src[i]);
+                    emit({ChangeKind::Insert, row, 1});
+                }
+            }
+            break;
+        case ChangeKind::Reset:
+            rebuild();
+            emit({ChangeKind::Reset, 0, m_items.size()});
+            break;
+        }
+    }
+
+    const BasicList<T>* m_source;
+    Pred m_pred;
+    std::vector<size_t> m_rows;
+    BindingContext m_context;
+};
+
+template <class S, class U, class F>
+class MappedList : public BasicList<U> {
+    using BasicList<U>::m_items;
+    using BasicList<U>::emit;
+
+public:
+    MappedList(const BasicList<S>& source, F func) :
+        m_source(&source), m_func(std::move(func)) {
+        rebuild();
+        const_cast<BasicList<S>&>(source).onListChanged(m_context, [this](const ListChange& c) { onSourceChanged(c); });
+    }
+
+private:
+    void rebuild() {
+        m_items.clear();
+        m_items.reserve(m_source->size());
+        for(const auto& v : m_source->value())
+            m_items.push_back(m_func(v));
+    }
+
+    void onSourceChanged(const ListChange& c) {
+        const auto& src = m_source->value();
+        switch(c.kind) {
+        case ChangeKind::Insert: {
+            std::vector<U> rows;
+            rows.reserve(c.count);
+            for(size_t i = c.first; i < c.first + c.count; ++i)
+                rows.push_back(m_func(src[i]));
+            m_items.insert(m_items.begin() + c.first, std::make_move_iterator(rows.begin()), std::make_move_iterator(rows.end()));
+            break;
+        }
+        case ChangeKind::Erase:
+            m_items.erase(m_items.begin() + c.first, m_items.begin() + c.first + c.count);
+            break;
+        case ChangeKind::Update:
+            for(size_t i = c.first; i < c.first + c.count; ++i)
+                m_items[i] = m_func(src[i]);
+            break;
+        case ChangeKind::Reset:
+            rebuild();
+            break;
+        }
+        emit(c);
+    }
+
+    const BasicList<S>* m_source;
+    F m_func;
+    BindingContext m_context;
+};
+
+template <class T, class Compare>
+class SortedList : public BasicList<T> {
+    using BasicList<T>::m_items;
+    using BasicList<T>::emit;
+
+public:
+    SortedList(const BasicList<T>& source, Compare comp) :
+        m_source(&source), m_comp(std::move(comp)) {
+        rebuild();
+        const_cast<BasicList<T>&>(source).onListChanged(m_context, [this](const ListChange& c) { onSourceChanged(c); });
+    }
+
+    size_t sourceIndex(size_t row) const { return m_rows[row]; }
+
+private:
+    void rebuild() {
+        const auto& src = m_source->value();
+        m_rows.resize(src.size());
+        for(size_t i = 0; i < src.size(); ++i)
+            m_rows[i] = i;
+        std::stable_sort(m_rows.begin(), m_rows.end(), [&](size_t a, size_t b) { return m_comp(src[a], src[b]); });
+        m_items.clear();
+        m_items.reserve(src.size());
+        for(size_t i : m_rows)
+            m_items.push_back(src[i]);
+    }
+
+    void insertRow(size_t sourceIndex) {
+        const T& v = m_source->value()[sourceIndex];
+        size_t row = std::upper_bound(m_items.begin(), m_items.end(), v, m_comp) - m_items.begin();
+        m_rows.insert(m_rows.begin() + row, sourceIndex);
+        m_items.insert(m_items.begin() + row, v);
+        emit({ChangeKind::Insert, row, 1});
+    }
+
+    void onSourceChanged(const ListChange& c) {
+        switch(c.kind) {
+        case ChangeKind::Insert:
+            for(auto& r : m_rows) {
+                if(r >= c.first)
+                    r += c.count;
+            }
+            for(size_t i = c.first; i < c.first + c.count; ++i)
+                insertRow(i);
+            break;
+        case ChangeKind::Erase:
+            // Walk backwards so every emitted row index is valid at the time it is seen.
+            for(size_t row = m_rows.size(); row-- > 0;) {
+                if(m_rows[row] >= c.first && m_rows[row] < c.first + c.count) {
+                    m_rows.erase(m_rows.begin() + row);
+                    m_items.erase(m_items.begin() + row);
+                    emit({ChangeKind::Erase, row, 1});
+                }
+            }
+            for(auto& r : m_rows) {
+                if(r >= c.first + c.count)
+                    r -= c.count;
+            }
+            break;
+        case ChangeKind::Update:
+            for(size_t i = c.first; i < c.first + c.count; ++i) {
+                size_t row = std::find(m_rows.begin(), m_rows.end(), i) - m_rows.begin();
+                const T& v = m_source->value()[i];
+                bool inPlace = (row == 0 || !m_comp(v, m_items[row - 1]))
+                            && (row + 1 == m_items.size() || !m_comp(m_items[row + 1], v));
+                if(inPlace) {
+                    m_items[row] = v;
+                    emit({ChangeKind::Update, row, 1});
+                } else {
+                    m_rows.erase(m_rows.begin() + row);
+                    m_items.erase(m_items.begin() + row);
+                    emit({ChangeKind::Erase, row, 1});
+                    insertRow(i);
+                }
+            }
+            break;
+        case ChangeKind::Reset:
+            rebuild();
+            emit({ChangeKind::Reset, 0, m_items.size()});
+            break;
+        }
+    }
+
+    const BasicList<T>* m_source;
+    Compare m_comp;
+    std::vector<size_t> m_rows;
+    BindingContext m_context;
+};
+
+template <class T, class Pred>
+requires std::predicate<Pred&, const T&>
+inline auto filtered(const BasicList<T>& source, Pred&& pred) {
+    return FilteredList<T, std::decay_t<Pred>>(source, std::forward<Pred>(pred));
+}
+
+template <class T, class F>
+requires std::invocable<F&, const T&>
+inline auto mapped(const BasicList<T>& source, F&& func) {
+    using U = std::decay_t<std::invoke_result_t<F&, const T&>>;
+    return MappedList<T, U, std::decay_t<F>>(source, std::forward<F>(func));
+}
+
+template <class T, class Compare = std::less<T>>
+inline auto sorted(const BasicList<T>& source, Compare&& comp = {}) {
+    return SortedList<T, std::decay_t<Compare>>(source, std::forward<Compare>(comp));
+}
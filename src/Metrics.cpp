@@ -0,0 +1,131 @@
+#include "Metrics.hpp"
+
+#include <algorithm>
+#include <cinttypes>
+#include <cstdio>
+#include <mutex>
+#include <vector>
+
+// Blocks of live threads, plus the sums left by threads that have exited.
+// Never destroyed: threads may still exit while statics are torn down.
+struct PropertyMetrics::Registry {
+    std::mutex mutex;
+    std::vector<Block*> blocks;
+    Snapshot retired;
+    // Taken by objects that die on a thread after its block has gone, such as
+    // properties with static or thread storage duration. Several exiting
+    // threads may write it at once.
+    Block orphan;
+
+    Registry() { orphan.shared = true; }
+
+    static Registry& get() {
+        static Registry* r = new Registry;
+        return *r;
+    }
+};
+
+namespace {
+
+thread_local bool t_exited = false;
+
+void append(std::string& out, const char* format, auto... args) {
+    char line[160];
+    int n = std::snprintf(line, sizeof(line), format, args...);
+    out.append(line, static_cast<size_t>(std::min<int>(n, sizeof(line) - 1)));
+}
+
+} // namespace
+
+void PropertyMetrics::merge(Snapshot& s, const Block& b) {
+    for(size_t i = 0; i < s.gauges.size(); ++i)
+        s.gauges[i] += b.gauges[i].load(std::memory_order_relaxed);
+    for(size_t i = 0; i < s.counters.size(); ++i)
+        s.counters[i] += b.counters[i].load(std::memory_order_relaxed);
+    for(auto [to, from] : {std::pair{&s.latencyNs, &b.latency}, std::pair{&s.fanout, &b.fanout}}) {
+        for(size_t i = 0; i < to->buckets.size(); ++i)
+            to->buckets[i] += from->buckets[i].load(std::memory_order_relaxed);
+        to->count += from->count.load(std::memory_order_relaxed);
+        to->sum += from->sum.load(std::memory_order_relaxed);
+    }
+}
+
+PropertyMetrics::Block* PropertyMetrics::attach() {
+    if(t_exited)
+        return &Registry::get().orphan;
+    // Owns the block of one thread; at exit its sums move to the registry.
+    struct Owner {
+        Block block;
+
+        Owner() {
+            auto& r = Registry::get();
+            std::lock_guard lock(r.mutex);
+            r.blocks.push_back(&block);
+        }
+
+        ~Owner() {
+            auto& r = Registry::get();
+            std::lock_guard lock(r.mutex);
+            std::erase(r.blocks, &block);
+            merge(r.retired, block);
+            t_block = nullptr;
+            t_exited = true;
+        }
+    };
+    thread_local Owner owner;
+    return &owner.block;
+}
+
+PropertyMetrics::Snapshot PropertyMetrics::snapshot() {
+    auto& r = Registry::get();
+    std::lock_guard lock(r.mutex);
+    Snapshot s = r.retired;
+    s.timeNs = now();
+    for(Block* b : r.blocks)
+        merge(s, *b);
+    merge(s, r.orphan);
+    return s;
+}
+
+uint64_t PropertyMetrics::Histogram::quantile(double q) const {
+    if(!count)
+        return 0;
+    uint64_t rank = static_cast<uint64_t>(q * static_cast<double>(count - 1)) + 1;
+    uint64_t seen = 0;
+    for(size_t i = 0; i < buckets.size(); ++i) {
+        seen += buckets[i];
+        if(seen >= rank)
+            return upperBound(i);
+    }
+    return upperBound(buckets.size() - 1);
+}
+
+double PropertyMetrics::Snapshot::rate(Counter c, const Snapshot& since) const {
+    if(timeNs <= since.timeNs)
+        return 0;
+    return static_cast<double>(counters[c] - since.counters[c]) * 1e9 / static_cast<double>(timeNs - since.timeNs);
+}
+
+std::string PropertyMetrics::Snapshot::text(const Snapshot* since) const {
+    static const char* const GaugeNames[GaugeCount] = {"property_live_properties", "property_live_bound", "property_live_data",
+                                                       "property_live_links", "property_live_observers", "property_bytes"};
+    static const char* const CounterNames[CounterCount] = {"property_writes", "property_waves", "property_notifiers_fired"};
+    std::string out;
+    for(int g = 0; g < GaugeCount; ++g)
+        append(out, "%s %" PRId64 "\n", GaugeNames[g], gauges[g]);
+    for(int c = 0; c < CounterCount; ++c) {
+        append(out, "%s_total %" PRIu64 "\n", CounterNames[c], counters[c]);
+        if(since)
+            append(out, "%s_per_second %.1f\n", CounterNames[c], rate(static_cast<Counter>(c), *since));
+    }
+    auto histogram = [&out](const char* name, const Histogram& h) {
+        for(double q : {0.5, 0.9, 0.99, 0.999})
+            append(out, "%s{quantile=\"%g\"} %" PRIu64 "\n", name, q, h.quantile(q));
+        append(out, "%s_max %" PRIu64 "\n", name, h.quantile(1));
+        append(out, "%s_sum %" PRIu64 "\n", name, h.sum);
+        append(out, "%s_count %" PRIu64 "\n", name, h.count);
+    };
+    histogram("property_propagation_latency_ns", latencyNs);
+    histogram("property_wave_fanout", fanout);
+    return out;
+}
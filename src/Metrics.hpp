@@ -0,0 +1,184 @@
+#pragma once
+
+#include <array>
+#include <atomic>
+#include <bit>
+#include <chrono>
+#include <cstdint>
+#include <string>
+#include <type_traits>
+
+// PropertyMetrics counts what the binding engine holds and does, for export to
+// a monitoring system. Every thread updates a block of its own with plain
+// relaxed stores, so recording never contends; snapshot() sums the blocks of
+// all threads, including those that have exited. Gauges and counters are always
+// on. Propagation latency needs two clock reads per wave and is only measured
+// while enableTiming(true) is in effect.
+class PropertyMetrics {
+public:
+    enum Gauge {
+        Properties, // live BasicProperty objects
+        Bound,      // live properties with binding state (bound, shared or observed)
+        Data,       // live PropertyData, i.e. stored or bound values outside a property
+        Links,      // live upstream links between notifiers
+        Observers,  // live observer callbacks
+        Bytes,      // heap held by property data and binding state, not counting what values own
+        GaugeCount
+    };
+
+    enum Counter {
+        Writes, // setValue calls
+        Waves,  // propagation waves
+        Fired,  // notifiers fired by waves
+        CounterCount
+    };
+
+    // Log-linear buckets: four per power of two, so any recorded value is
+    // known to within 25%.
+    struct Histogram {
+        static constexpr size_t SubBuckets = 4;
+        static constexpr size_t BucketCount = 64 * SubBuckets;
+
+        static size_t bucket(uint64_t v) {
+            if(v < SubBuckets)
+                return v;
+            int msb = std::bit_width(v) - 1;
+            return msb * SubBuckets + ((v >> (msb - 2)) & (SubBuckets - 1));
+        }
+
+        // Largest value that lands in bucket i.
+        static uint64_t upperBound(size_t i) {
+            if(i < SubBuckets)
+                return i;
+            size_t msb = i / SubBuckets;
+            uint64_t base = uint64_t(1) << msb;
+            uint64_t step = base / SubBuckets;
+            return base + step * (i % SubBuckets + 1) - 1;
+        }
+
+        std::array<uint64_t, BucketCount> buckets{};
+        uint64_t count = 0;
+        uint64_t sum = 0;
+
+        // Upper bound of the bucket holding quantile q (0..1), 0 when empty.
+        uint64_t quantile(double q) const;
+    };
+
+    struct Snapshot {
+        uint64_t timeNs = 0;
+        std::array<int64_t, GaugeCount> gauges{};
+        std::array<uint64_t, CounterCount> counters{};
+        Histogram latencyNs; // from the start of a wave to its last observer
+        Histogram fanout;    // notifiers fired per wave
+
+        // Counter increase per second since an earlier snapshot.
+        double rate(Counter c, const Snapshot& since) const;
+
+        // Text exposition, one metric per line. Rates are included when an
+        // earlier snapshot is given.
+        std::string text(const Snapshot* since = nullptr) const;
+    };
+
+    static void live(Gauge g, int64_t n) {
+        Block& b = local();
+        add(b, b.gauges[g], n);
+    }
+
+    static void live(Gauge g, int64_t n, int64_t bytes) {
+        Block& b = local();
+        add(b, b.gauges[g], n);
+        add(b, b.gauges[Bytes], bytes);
+    }
+
+    static void count(Counter c, uint64_t n = 1) {
+        Block& b = local();
+        add(b, b.counters[c], n);
+    }
+
+    static void wave(uint64_t fired, uint64_t latencyNs) {
+        Block& b = local();
+        add(b, b.counters[Waves], 1);
+        add(b, b.counters[Fired], fired);
+        record(b, b.fanout, fired);
+        if(latencyNs)
+            record(b, b.latency, latencyNs);
+    }
+
+    static bool timing() { return s_timing.load(std::memory_order_relaxed); }
+
+    static void enableTiming(bool on) { s_timing.store(on, std::memory_order_relaxed); }
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+    static Snapshot snapshot();
+
+private:
+    struct AtomicHistogram {
+        std::array<std::atomic<uint64_t>, Histogram::BucketCount> buckets{};
+        std::atomic<uint64_t> count = 0;
+        std::atomic<uint64_t> sum = 0;
+    };
+
+    struct Block {
+        std::array<std::atomic<int64_t>, GaugeCount> gauges{};
+        std::array<std::atomic<uint64_t>, CounterCount> counters{};
+        AtomicHistogram latency;
+        AtomicHistogram fanout;
+        bool shared = false; // written by several threads
+    };
+
+    // Only the owning thread writes a block of its own, so a load and a store
+    // replace the locked read-modify-write; a shared block needs the real one.
+    template <class T, class N>
+    static void add(const Block& b, std::atomic<T>& a, N n) {
+        if(b.shared) [[unlikely]]
+            a.fetch_add(static_cast<T>(n), std::memory_order_relaxed);
+        else
+            a.store(a.load(std::memory_order_relaxed) + static_cast<T>(n), std::memory_order_relaxed);
+    }
+
+    static void record(const Block& b, AtomicHistogram& h, uint64_t v) {
+        add(b, h.buckets[Histogram::bucket(v)], 1);
+        add(b, h.count, 1);
+        add(b, h.sum, v);
+    }
+
+    static Block& local() {
+        if(!t_block) [[unlikely]]
+            t_block = attach();
+        return *t_block;
+    }
+
+    struct Registry;
+
+    static Block* attach();
+
+    static void merge(Snapshot& s, const Block& b);
+
+    inline static constinit thread_local Block* t_block = nullptr;
+    inline static std::atomic<bool> s_timing = false;
+};
+
+// Counts one live object of kind G, and sizeof(Sized) towards
+// PropertyMetrics::Bytes, for as long as the object holding it exists. Copies
+// count separately.
+template <PropertyMetrics::Gauge G, class Sized = void>
+class MetricToken {
+public:
+    // noexcept so that holders stay nothrow-movable and vectors of them move
+    // their elements on reallocation.
+    MetricToken() noexcept { add(1); }
+    MetricToken(const MetricToken&) noexcept { add(1); }
+    MetricToken& operator=(const MetricToken&) noexcept { return *this; }
+    ~MetricToken() { add(-1); }
+
+private:
+    static void add(int64_t n) {
+        if constexpr(std::is_void_v<Sized>)
+            PropertyMetrics::live(G, n);
+        else
+            PropertyMetrics::live(G, n, n * static_cast<int64_t>(sizeof(Sized)));
+    }
+};
@@ -0,0 +1,257 @@
+#include "Property.hpp"
+
+void BindingNotifier::notify() {
+    m_version = ChangeEpoch::next();
+    if(s_deferDepth > 0) {
+        auto& h = handle();
+        if(!h->queued) {
+            h->queued = true;
+            s_pending.push_back(h);
+        }
+        return;
+    }
+    std::shared_ptr<Data> source = handle();
+    propagate(std::span(&source, 1));
+}
+
+void BindingNotifier::fire(ObserverPriority priority) {
+    auto& list = observers(priority);
+    ++m_firing;
+    for(auto it = list.begin(); it != list.end(); ++it) {
+        if(!it->dead && it->func()) {
+            it->dead = true;
+            ++m_dead;
+        }
+    }
+    if(--m_firing == 0 && m_dead > 0) {
+        for(auto& l : m_observers)
+            std::erase_if(l, [](const Observer& o) { return o.dead; });
+        m_dead = 0;
+    }
+}
+
+void BindingNotifier::removeObserver(BindingNotifier::ObserverList::iterator it, ObserverPriority priority) {
+    if(it->dead)
+        return;
+    if(m_firing > 0) {
+        it->dead = true;
+        ++m_dead;
+    } else {
+        observers(priority).erase(it);
+    }
+}
+
+void BindingNotifier::link(BindingNotifier* upstream) {
+    for(const auto& u : m_upstream) {
+        if(u.source.lock() == upstream->ptr && upstream->ptr)
+            return;
+    }
+    upstream->m_bindings.push_back(handle());
+    m_upstream.push_back({upstream->handle(), std::prev(upstream->m_bindings.end())});
+}
+
+void BindingNotifier::unbind() {
+    for(auto& u : m_upstream) {
+        if(auto source = u.source.lock(); source && source->obs)
+            source->obs->m_bindings.erase(u.link);
+    }
+    m_upstream.clear();
+}
+
+void BindingNotifier::resetNotifier() {
+    unbind();
+    for(auto it = m_bindings.begin(); it != m_bindings.end(); ++it) {
+        if(auto next = it->lock(); next && next->obs)
+            std::erase_if(next->obs->m_upstream, [it](const Upstream& u) { return u.link == it; });
+    }
+    m_bindings.clear();
+}
+
+void BindingNotifier::rebind(const std::vector<BindingNotifier*>& notifiers) {
+    std::erase_if(m_upstream, [&notifiers](const Upstream& u) {
+        auto source = u.source.lock();
+        if(!source || !source->obs)
+            return true;
+        if(std::ranges::find(notifiers, source->obs) != notifiers.end())
+            return false;
+        source->obs->m_bindings.erase(u.link);
+        return true;
+    });
+    for(auto ntf : notifiers)
+        link(ntf);
+}
+
+bool BindingNotifier::reaches(const std::vector<BindingNotifier*>& notifiers) {
+    if(std::ranges::find(notifiers, this) != notifiers.end())
+        return true;
+    if(!ptr)
+        return false;
+    // Walks upstream from the notifiers, marking visited nodes with a fresh
+    // wave number; the search stack is borrowed from the wave buffer pool.
+    const uint64_t mark = ++s_wave;
+    WaveBuffers buffers;
+    if(!s_wavePool.empty()) {
+        buffers = std::move(s_wavePool.back());
+        s_wavePool.pop_back();
+    }
+    auto& stack = buffers.order;
+    for(auto ntf : notifiers) {
+        if(ntf->ptr && ntf->ptr->wave != mark) {
+            ntf->ptr->wave = mark;
+            stack.push_back(ntf->ptr);
+        }
+    }
+    bool found = false;
+    while(!stack.empty() && !found) {
+        auto node = std::move(stack.back());
+        stack.pop_back();
+        if(!node->obs)
+            continue;
+        for(const auto& u : node->obs->m_upstream) {
+            auto source = u.source.lock();
+            if(!source || source->wave == mark)
+                continue;
+            if(source == ptr) {
+                found = true;
+                break;
+            }
+            source->wave = mark;
+            stack.push_back(std::move(source));
+        }
+    }
+    stack.clear();
+    s_wavePool.push_back(std::move(buffers));
+    return found;
+}
+
+void BindingNotifier::propagate(std::span<const std::shared_ptr<BindingNotifier::Data>> sources) {
+    const uint64_t begin = PropertyMetrics::timing() ? PropertyMetrics::now() : 0;
+    const uint64_t wave = ++s_wave;
+    // Buffers are reused across waves; a wave started by an observer takes
+    // its own from the pool.
+    WaveBuffers buffers;
+    if(!s_wavePool.empty()) {
+        buffers = std::move(s_wavePool.back());
+        s_wavePool.pop_back();
+    }
+    auto& order = buffers.order;
+    auto& stack = buffers.stack;
+    for(const auto& source : sources) {
+        if(!source->obs || source->wave == wave)
+            continue;
+        source->wave = wave;
+        stack.emplace_back(source, source->obs->m_bindings.begin());
+        while(!stack.empty()) {
+            auto& [node, it] = stack.back();
+            auto& links = node->obs->m_bindings;
+            if(it == links.end()) {
+                order.push_back(std::move(node));
+                stack.pop_back();
+                continue;
+            }
+            auto next = it->lock();
+            if(!next || !next->obs) {
+                it = links.erase(it);
+                continue;
+            }
+            ++it;
+            if(next->wave == wave)
+                continue;
+            next->wave = wave;
+            auto begin = next->obs->m_bindings.begin();
+            stack.emplace_back(std::move(next), begin);
+        }
+    }
+    std::reverse(order.begin(), order.end());
+    s_fired += order.size();
+    const uint64_t epoch = ChangeEpoch::next();
+    for(const auto& node : order) {
+        if(auto obs = node->obs)
+            obs->m_version = epoch;
+    }
+    for(const auto& node : order) {
+        if(auto obs = node->obs)
+            obs->fire(ObserverPriority::Immediate);
+    }
+    for(const auto& node : order) {
+        if(auto obs = node->obs)
+            obs->fire(ObserverPriority::Normal);
+    }
+    for(const auto& node : order) {
+        auto obs = node->obs;
+        if(!obs || obs->observers(ObserverPriority::Idle).empty())
+            continue;
+        if(!s_idleQueue)
+            obs->fire(ObserverPriority::Idle);
+        else if(!node->idleQueued) {
+            node->idleQueued = true;
+            s_idleQueue->push_back(node);
+        }
+    }
+    PropertyMetrics::wave(order.size(), begin ? PropertyMetrics::now() - begin : 0);
+    order.clear();
+    s_wavePool.push_back(std::move(buffers));
+}
+
+size_t BindingNotifier::propagatePending() {
+    // Swapping with the spare keeps both buffers' capacity across flushes.
+    std::vector<std::shared_ptr<Data>> pending = std::move(s_spare);
+    pending.swap(s_pending);
+    for(auto& h : pending)
+        h->queued = false;
+    propagate(pending);
+    size_t n = pending.size();
+    pending.clear();
+    s_spare = std::move(pending);
+    return n;
+}
+
+void BindingNotifier::flushPending() {
+    while(!s_pending.empty())
+        propagatePending();
+}
+
+size_t IdleQueue::drain(std::chrono::nanoseconds budget) {
+    auto start = std::chrono::steady_clock::now();
+    size_t n = 0;
+    while(!m_queue.empty()) {
+        auto node = m_queue.front().lock();
+        m_queue.pop_front();
+        if(!node)
+            continue;
+        node->idleQueued = false;
+        if(node->obs) {
+            node->obs->fire(ObserverPriority::Idle);
+            ++n;
+        }
+        if(std::chrono::steady_clock::now() - start >= budget)
+            break;
+    }
+    return n;
+}
+
+void PropertyTeardown::finish() {
+    // Data whose last holders died inside the scope is already gone.
+    for(auto& d : s_deferred) {
+        if(auto data = d.data.lock())
+            d.freeze(data.get());
+    }
+    s_deferred.clear();
+}
+
+template class PropertyData<bool>;
+template class OneValue<bool>;
+template class BasicProperty<bool, true>;
+template class BasicProperty<bool, false>;
+template class PropertyData<int>;
+template class OneValue<int>;
+template class BasicProperty<int, true>;
+template class BasicProperty<int, false>;
+template class PropertyData<double>;
+template class OneValue<double>;
+template class BasicProperty<double, true>;
+template class BasicProperty<double, false>;
+template class PropertyData<std::string>;
+template class OneValue<std::string>;
+template class BasicProperty<std::string, true>;
+template class BasicProperty<std::string, false>;
@@ -1,8 +1,17 @@
 #pragma once
 
+#include <algorithm>
+#include <array>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <deque>
 #include <type_traits>
 #include <list>
+#include <mutex>
 #include <iterator>
+#include <span>
+#include <string>
 
 #include "Calc.hpp"
 #include "PropertyData.hpp"
@@ -13,6 +22,9 @@ class BasicProperty;
 template <typename T, std::invocable F>
 class PropertyBinding;
 
+template <typename T, std::invocable F>
+class ComputedBinding;
+
 template <typename T>
 class PropertyData;
 
@@ -33,6 +45,12 @@ struct type_traits_impl<PropertyBinding<T, F>> {
     using func_type = F;
 };
 
+template <class T, class F>
+struct type_traits_impl<ComputedBinding<T, F>> {
+    using value_type = T;
+    using func_type = F;
+};
+
 template <class T>
 using value_t = typename type_traits_impl<std::decay_t<T>>::value_type;
 
@@ -51,6 +69,9 @@ concept IsProperty = std::same_as<C, BasicProperty<typename C::ValueType, C::IsW
 template <class T, class C = std::decay_t<T>>
 concept IsPropertyBinding = std::same_as<C, PropertyBinding<typename C::ValueType, typename C::FuncType>>;
 
+template <class T, class C = std::decay_t<T>>
+concept IsComputed = std::same_as<C, ComputedBinding<typename C::ValueType, typename C::FuncType>>;
+
 template <class V>
 concept IsNotPB = requires(V&& v) {
     requires !(IsPropertyBinding<V> || IsProperty<V>);
@@ -66,96 +87,553 @@ concept CanBeCalcOne = requires(T&& v) {
     {O::calc(v)};
 };
 
-class BindingContext {
-    friend class BindingNotifier;
-    std::shared_ptr<bool> ptr = std::make_shared<bool>(true);
+class Connection;
+class BindingContext;
+class BindingNotifier;
 
+// While a DependencyTracker is alive on this thread, every property read
+// (value(), ref() and the read accessors of lists and maps) is recorded in it.
+// Trackers nest: a computed() evaluated inside another one records into its own
+// tracker only. Outside a tracker a read costs one thread-local load.
+class DependencyTracker {
 public:
-    BindingContext(const BindingContext&) = delete;
-    BindingContext(BindingContext&&) = default;
-    void reset() {
-        ptr = std::make_shared<bool>(true);
+    DependencyTracker() :
+        m_previous(s_current) {
+        if(!s_spare.empty()) {
+            m_reads = std::move(s_spare.back());
+            s_spare.pop_back();
+        }
+        s_current = this;
+    }
+
+    DependencyTracker(const DependencyTracker&) = delete;
+    DependencyTracker& operator=(const DependencyTracker&) = delete;
+
+    ~DependencyTracker() {
+        s_current = m_previous;
+        m_reads.clear();
+        s_spare.push_back(std::move(m_reads));
+    }
+
+    // In read order, with repeats.
+    const std::vector<BindingNotifier*>& reads() const { return m_reads; }
+
+    static bool active() { return s_current != nullptr; }
+
+    static void record(BindingNotifier* notifier) {
+        if(s_current) [[unlikely]]
+            s_current->m_reads.push_back(notifier);
+    }
+
+private:
+    std::vector<BindingNotifier*> m_reads;
+    DependencyTracker* m_previous;
+
+    inline static thread_local DependencyTracker* s_current = nullptr;
+    inline static thread_local std::vector<std::vector<BindingNotifier*>> s_spare;
+};
+
+// PropertyTracers installed with install() see every setValue on every thread,
+// the most recently installed first. Nothing is traced by default and the
+// check costs a single atomic load. A tracer takes itself out when destroyed;
+// destroy it while no other thread is writing properties.
+class PropertyTracer {
+public:
+    virtual ~PropertyTracer() { uninstall(this); }
+
+    // Called after the value is assigned and propagated; timeNs is the steady
+    // clock time the write started, fired the number of notifiers it fired.
+    virtual void onSetValue(const void* property, uint64_t timeNs, uint64_t propagationNs, uint32_t fired) = 0;
+
+    // The most recently installed tracer, nullptr if none is.
+    static PropertyTracer* current() { return s_current.load(std::memory_order_acquire); }
+
+    // Puts tracer in front of the installed ones; installing it again does nothing.
+    static void install(PropertyTracer* tracer) {
+        std::lock_guard lock(s_mutex);
+        for(auto t = current(); t; t = t->next()) {
+            if(t == tracer)
+                return;
+        }
+        tracer->m_next.store(current(), std::memory_order_relaxed);
+        s_current.store(tracer, std::memory_order_release);
     }
+
+    // Takes tracer out wherever it is among the installed ones.
+    static void uninstall(PropertyTracer* tracer) {
+        std::lock_guard lock(s_mutex);
+        for(std::atomic<PropertyTracer*>* link = &s_current; auto t = link->load(std::memory_order_relaxed); link = &t->m_next) {
+            if(t == tracer) {
+                link->store(t->next(), std::memory_order_release);
+                return;
+            }
+        }
+    }
+
+    // Hands one write to every installed tracer.
+    static void dispatch(const void* property, uint64_t timeNs, uint64_t propagationNs, uint32_t fired) {
+        for(auto t = current(); t; t = t->next())
+            t->onSetValue(property, timeNs, propagationNs, fired);
+    }
+
+    static uint64_t now() {
+        return std::chrono::duration_cast<std::chrono::nanoseconds>(std::chrono::steady_clock::now().time_since_epoch()).count();
+    }
+
+private:
+    PropertyTracer* next() const { return m_next.load(std::memory_order_acquire); }
+
+    std::atomic<PropertyTracer*> m_next = nullptr; // installed before this one
+
+    inline static std::atomic<PropertyTracer*> s_current = nullptr;
+    inline static std::mutex s_mutex;
+};
+
+// Observers of a wave run by priority class: all Immediate observers first,
+// then Normal ones, then Idle ones, each class in topological order. Idle
+// observers are handed to the thread's IdleQueue when one is installed.
+// Bindings themselves are evaluated lazily on read and need no scheduling.
+enum class ObserverPriority : uint8_t {
+    Immediate,
+    Normal,
+    Idle
 };
 
 class BindingNotifier {
+    friend class PropertyBatch;
+    friend class NotifyScheduler;
+    friend class IdleQueue;
+    friend class Connection;
+
+    template <typename U, bool>
+    friend class BasicProperty;
+
+    template <class T>
+    friend class BasicList;
+
     struct Data {
         BindingNotifier* obs = nullptr;
+        uint64_t wave = 0;
+        bool queued = false;
+        bool idleQueued = false;
     };
-    std::shared_ptr<Data> ptr{new Data{this}};
+    // Created on demand, only notifiers that have upstream links need one.
+    std::shared_ptr<Data> ptr;
 
 public:
     BindingNotifier() = default;
     BindingNotifier(const BindingNotifier&) = delete;
     BindingNotifier(BindingNotifier&& obs) :
-        ptr(std::move(obs.ptr)) { ptr->obs = this; }
+        ptr(std::move(obs.ptr)), m_observers(std::move(obs.m_observers)), m_bindings(std::move(obs.m_bindings)),
+        m_upstream(std::move(obs.m_upstream)), m_version(obs.m_version) {
+        if(ptr)
+            ptr->obs = this;
+    }
 
     BindingNotifier& operator=(const BindingNotifier& obs) = delete;
 
     BindingNotifier& operator=(BindingNotifier&& obs) {
         if(&obs == this)
             return *this;
+        if(ptr)
+            ptr->obs = nullptr;
         ptr = std::move(obs.ptr);
-        ptr->obs = this;
+        m_observers = std::move(obs.m_observers);
+        m_bindings = std::move(obs.m_bindings);
+        m_upstream = std::move(obs.m_upstream);
+        m_version = obs.m_version;
+        if(ptr)
+            ptr->obs = this;
         return *this;
     }
 
-    // virtual ~BindingNotifier() { }
-    // virtual void notify() = 0;
-
-    void notify() {
-        std::erase_if(m_observers, [](std::function<bool()>& func) -> bool {
-            return func();
-        });
-        std::erase_if(m_bindings, [](std::weak_ptr<Data>& ptr) -> bool {
-            auto data = ptr.lock();
-            if(!data)
-                return true;
-            data->obs->notify();
-            return false;
-        });
+    ~BindingNotifier() {
+        if(ptr)
+            ptr->obs = nullptr;
     }
 
-    void resetNotifier() { ptr.reset(); }
+    // Fires the observers of this notifier and of everything bound to it, each
+    // once and in topological order. Inside a PropertyBatch or under a
+    // NotifyScheduler the notifier is only queued, and everything queued
+    // propagates as one wave when the batch ends or the scheduler flushes.
+    void notify();
 
-    void binding(BindingNotifier* notifier) {
-        notifier->addObserver(this);
-    }
+    // Epoch of the last wave that reached this notifier, or of the last
+    // notify() on it; 0 if it never changed.
+    uint64_t version() const { return m_version; }
+
+    // Number of notifiers fired by waves on this thread so far.
+    static uint64_t firedCount() { return s_fired; }
+
+    // Cuts every link, upstream and downstream. Observers and the handle
+    // their Connections refer to are kept.
+    void resetNotifier();
+
+    void binding(BindingNotifier* notifier) { link(notifier); }
 
     void binding(const std::vector<BindingNotifier*>& notifiers) {
-        for(auto ntf : notifiers) {
-            ntf->addObserver(this);
-        }
+        for(auto ntf : notifiers)
+            link(ntf);
     }
 
-    void addObserver(BindingNotifier* obs) { m_bindings.push_back(obs->ptr); }
+    // Makes notifiers the upstream set of this notifier, unlinking the ones
+    // that are no longer in it and linking only the new ones. Downstream
+    // links are kept.
+    void rebind(const std::vector<BindingNotifier*>& notifiers);
+
+    // Unlinks this notifier from everything upstream of it.
+    void unbind();
+
+    // True if this notifier is one of notifiers or upstream of one of them,
+    // i.e. binding to them would close a cycle.
+    bool reaches(const std::vector<BindingNotifier*>& notifiers);
+
+    void addObserver(BindingNotifier* obs) { m_bindings.push_back(obs->handle()); }
 
     template <std::invocable F>
-    void addObserver(F&& f) {
-        m_observers.push_back([func = std::forward<F>(f)] {
+    void addObserver(F&& f, ObserverPriority priority = ObserverPriority::Normal) {
+        observers(priority).push_back({[func = std::forward<F>(f)] {
             func();
             return false;
-        });
+        }});
     }
 
+    // The observer is dropped on the first notify after context expires.
     template <std::invocable F>
-    void addObserver(const std::weak_ptr<void>& context, F&& f) {
-        m_observers.push_back([&context, func = std::forward<F>(f)] {
+    void addObserver(const std::weak_ptr<void>& context, F&& f, ObserverPriority priority = ObserverPriority::Normal) {
+        observers(priority).push_back({[context, func = std::forward<F>(f)] {
             if(context.expired())
                 return true;
             func();
             return false;
-        });
+        }});
     }
 
+    // The observer is removed eagerly when the context is reset or destroyed.
+    template <std::invocable F>
+    void addObserver(const BindingContext& context, F&& f, ObserverPriority priority = ObserverPriority::Normal);
+
+    // Like addObserver, but returns a handle that removes the observer in O(1).
+    template <std::invocable F>
+    Connection connect(F&& f, ObserverPriority priority = ObserverPriority::Normal);
+
+    // Wraps f so that every run records the properties it reads and makes
+    // them the upstream set of this notifier.
     template <std::invocable F>
-    void addObserver(const BindingContext& context, F&& f) {
-        addObserver(context.ptr, std::forward<F>(f));
+    auto tracking(F&& f) {
+        return [func = std::forward<F>(f), node = std::weak_ptr<Data>(handle())] {
+            DependencyTracker tracker;
+            auto value = func();
+            if(auto n = node.lock(); n && n->obs)
+                n->obs->rebind(tracker.reads());
+            return value;
+        };
     }
 
 private:
-    std::list<std::function<bool()>> m_observers;
+    const std::shared_ptr<Data>& handle() {
+        if(!ptr)
+            ptr = std::make_shared<Data>(Data{this});
+        return ptr;
+    }
+
+    using Link = std::list<std::weak_ptr<Data>>::iterator;
+
+    // An upstream notifier and this notifier's entry in its m_bindings.
+    struct Upstream {
+        std::weak_ptr<Data> source;
+        Link link;
+        [[no_unique_address]] MetricToken<PropertyMetrics::Links, Upstream> counted{};
+    };
+
+    static_assert(std::is_nothrow_move_constructible_v<Upstream>, "m_upstream must move, not copy, when it grows");
+
+    void link(BindingNotifier* upstream);
+
+    struct WaveBuffers {
+        std::vector<std::shared_ptr<Data>> order;
+        std::vector<std::pair<std::shared_ptr<Data>, Link>> stack;
+    };
+
+    // Observers removed while their list is being fired are only marked dead,
+    // and swept when that fire() returns.
+    struct Observer {
+        std::function<bool()> func;
+        bool dead = false;
+        [[no_unique_address]] MetricToken<PropertyMetrics::Observers, Observer> counted{};
+    };
+
+    using ObserverList = std::list<Observer>;
+
+    ObserverList& observers(ObserverPriority priority) { return m_observers[static_cast<size_t>(priority)]; }
+
+    void fire(ObserverPriority priority);
+
+    void removeObserver(ObserverList::iterator it, ObserverPriority priority);
+
+    // Collects everything reachable from the sources in reverse post-order, so
+    // a node shared by several paths (or sources) is fired once, after all of
+    // its inputs. The walk is iterative to survive long binding chains.
+    static void propagate(std::span<const std::shared_ptr<Data>> sources);
+
+    static size_t propagatePending();
+
+    static void flushPending();
+
+    std::array<ObserverList, 3> m_observers;
     std::list<std::weak_ptr<Data>> m_bindings;
+    std::vector<Upstream> m_upstream;
+    uint64_t m_version = 0;
+    uint32_t m_firing = 0;
+    uint32_t m_dead = 0;
+
+    inline static thread_local uint64_t s_wave = 0;
+    inline static thread_local uint64_t s_fired = 0;
+    inline static thread_local int s_deferDepth = 0;
+    inline static thread_local std::vector<std::shared_ptr<Data>> s_pending;
+    inline static thread_local std::vector<std::shared_ptr<Data>> s_spare;
+    inline static thread_local std::vector<WaveBuffers> s_wavePool;
+    inline static thread_local std::deque<std::weak_ptr<Data>>* s_idleQueue = nullptr;
+};
+
+// A Connection refers to one observer of a notifier. disconnect() unlinks it
+// from the observer list in O(1); it is a no-op once the notifier is gone.
+// Connections are move-only: a moved-from connection refers to nothing, so the
+// observer can only be unlinked once.
+class Connection {
+    friend class BindingNotifier;
+
+public:
+    Connection() = default;
+    Connection(const Connection&) = delete;
+    Connection& operator=(const Connection&) = delete;
+    Connection(Connection&&) = default;
+    Connection& operator=(Connection&&) = default;
+
+    bool connected() const {
+        auto data = m_notifier.lock();
+        return data && data->obs;
+    }
+
+    void disconnect() {
+        if(auto data = m_notifier.lock(); data && data->obs)
+            data->obs->removeObserver(m_it, m_priority);
+        m_notifier.reset();
+    }
+
+private:
+    Connection(const std::shared_ptr<BindingNotifier::Data>& notifier, BindingNotifier::ObserverList::iterator it,
+               ObserverPriority priority) :
+        m_notifier(notifier), m_it(it), m_priority(priority) { }
+
+    std::weak_ptr<BindingNotifier::Data> m_notifier;
+    BindingNotifier::ObserverList::iterator m_it;
+    ObserverPriority m_priority = ObserverPriority::Normal;
+};
+
+template <std::invocable F>
+Connection BindingNotifier::connect(F&& f, ObserverPriority priority) {
+    auto& list = observers(priority);
+    list.push_back({[func = std::forward<F>(f)] {
+        func();
+        return false;
+    }});
+    return Connection(handle(), std::prev(list.end()), priority);
+}
+
+// Disconnects itself when it goes out of scope.
+class ScopedConnection {
+public:
+    ScopedConnection() = default;
+    ScopedConnection(Connection connection) :
+        m_connection(std::move(connection)) { }
+
+    ScopedConnection(const ScopedConnection&) = delete;
+    ScopedConnection& operator=(const ScopedConnection&) = delete;
+
+    ScopedConnection(ScopedConnection&& o) :
+        m_connection(std::exchange(o.m_connection, {})) { }
+
+    ScopedConnection& operator=(ScopedConnection&& o) {
+        if(&o != this) {
+            m_connection.disconnect();
+            m_connection = std::exchange(o.m_connection, {});
+        }
+        return *this;
+    }
+
+    ~ScopedConnection() { m_connection.disconnect(); }
+
+    bool connected() const { return m_connection.connected(); }
+    void disconnect() { m_connection.disconnect(); }
+
+    // Gives up ownership; the observer stays connected.
+    Connection release() { return std::exchange(m_connection, {}); }
+
+private:
+    Connection m_connection;
+};
+
+// Owns the observers registered with it and disconnects all of them when it is
+// reset or destroyed, so tearing down a screen removes its observers at once
+// instead of leaving them to be found expired on a later notify.
+class BindingContext {
+    friend class BindingNotifier;
+
+public:
+    BindingContext() = default;
+    BindingContext(const BindingContext&) = delete;
+    BindingContext(BindingContext&&) = default;
+
+    BindingContext& operator=(BindingContext&& o) {
+        if(&o != this) {
+            reset();
+            m_connections = std::move(o.m_connections);
+        }
+        return *this;
+    }
+
+    ~BindingContext() { reset(); }
+
+    void reset() {
+        for(auto& c : m_connections)
+            c.disconnect();
+        m_connections.clear();
+    }
+
+    size_t size() const { return m_connections.size(); }
+
+private:
+    void add(Connection connection) const { m_connections.push_back(std::move(connection)); }
+
+    mutable std::vector<Connection> m_connections;
+};
+
+template <std::invocable F>
+void BindingNotifier::addObserver(const BindingContext& context, F&& f, ObserverPriority priority) {
+    context.add(connect(std::forward<F>(f), priority));
+}
+
+// While a PropertyBatch is alive on this thread, notifications are collected
+// instead of propagated; the outermost batch propagates them as a single wave
+// when it goes out of scope, so an observer depending on several changed
+// properties fires once.
+class PropertyBatch {
+public:
+    PropertyBatch() { ++BindingNotifier::s_deferDepth; }
+    PropertyBatch(const PropertyBatch&) = delete;
+    PropertyBatch& operator=(const PropertyBatch&) = delete;
+
+    ~PropertyBatch() {
+        if(--BindingNotifier::s_deferDepth == 0)
+            BindingNotifier::flushPending();
+    }
+};
+
+// An IdleQueue installed on a thread collects the Idle observers of every wave
+// instead of running them inline. drain() runs them later, within a time
+// budget; each notifier is queued once, so its observers see the latest value.
+// Whatever is left runs when the queue is destroyed.
+class IdleQueue {
+public:
+    IdleQueue() :
+        m_previous(BindingNotifier::s_idleQueue) { BindingNotifier::s_idleQueue = &m_queue; }
+
+    IdleQueue(const IdleQueue&) = delete;
+    IdleQueue& operator=(const IdleQueue&) = delete;
+
+    ~IdleQueue() {
+        drain(std::chrono::nanoseconds::max());
+        BindingNotifier::s_idleQueue = m_previous;
+    }
+
+    // Runs queued notifiers until the budget is spent, at least one per call.
+    // Returns the number of notifiers run.
+    size_t drain(std::chrono::nanoseconds budget);
+
+    size_t pending() const { return m_queue.size(); }
+
+private:
+    std::deque<std::weak_ptr<BindingNotifier::Data>> m_queue;
+    std::deque<std::weak_ptr<BindingNotifier::Data>>* m_previous;
+};
+
+// NotifyScheduler defers every notification on its thread until flush(), which
+// propagates all sources written since the previous flush as one wave: each
+// observer fires at most once per flush and sees the final value, however often
+// the sources were written. Writes made by observers during a flush are queued
+// for the next flush. Drive flush() from the frame loop or a timer; whatever is
+// still queued propagates when the scheduler is destroyed.
+class NotifyScheduler {
+public:
+    NotifyScheduler() :
+        m_previous(s_current) {
+        ++BindingNotifier::s_deferDepth;
+        s_current = this;
+    }
+
+    NotifyScheduler(const NotifyScheduler&) = delete;
+    NotifyScheduler& operator=(const NotifyScheduler&) = delete;
+
+    ~NotifyScheduler() {
+        s_current = m_previous;
+        if(--BindingNotifier::s_deferDepth == 0)
+            BindingNotifier::flushPending();
+    }
+
+    // Returns the number of queued sources that were propagated.
+    size_t flush() { return BindingNotifier::propagatePending(); }
+
+    size_t pending() const { return BindingNotifier::s_pending.size(); }
+
+    // The innermost scheduler installed on this thread, if any.
+    static NotifyScheduler* current() { return s_current; }
+
+private:
+    NotifyScheduler* m_previous;
+    inline static thread_local NotifyScheduler* s_current = nullptr;
+};
+
+// Inside a PropertyTeardown, dying properties do not snapshot their bindings one
+// by one. Each drops its data right away, so data used only by other dying
+// properties is freed without ever being evaluated; when the outermost scope
+// ends, the data still held by survivors is frozen to its current value. Writes
+// made inside the scope can show up in those values.
+class PropertyTeardown {
+    template <typename U, bool>
+    friend class BasicProperty;
+
+public:
+    PropertyTeardown() { ++s_depth; }
+    PropertyTeardown(const PropertyTeardown&) = delete;
+    PropertyTeardown& operator=(const PropertyTeardown&) = delete;
+
+    ~PropertyTeardown() {
+        if(--s_depth == 0)
+            finish();
+    }
+
+    static bool active() { return s_depth > 0; }
+
+private:
+    struct Deferred {
+        std::weak_ptr<void> data;
+        void (*freeze)(void* data);
+    };
+
+    template <class T>
+    static void defer(const std::shared_ptr<PropertyData<T>>& data) {
+        s_deferred.push_back({data, [](void* p) {
+            auto data = static_cast<PropertyData<T>*>(p);
+            if(!data->isStored())
+                data->setValue(data->value());
+        }});
+    }
+
+    static void finish();
+
+    inline static thread_local int s_depth = 0;
+    inline static thread_local std::vector<Deferred> s_deferred;
 };
 
 // PropertyBinding is mainly for handling ownership. If you assign PropertyBinding to Property,
@@ -211,9 +689,34 @@ private:
 template <class F>
 PropertyBinding(F) -> PropertyBinding<decltype(std::declval<F>()()), F>;
 
+// computed() turns any function of properties into a binding. The properties it
+// reads are recorded on every evaluation and become exactly its upstream set, so
+// a branch or a loop subscribes to what it actually touched and nothing else.
+template <typename T, std::invocable F>
+class ComputedBinding {
+    template <typename U, bool>
+    friend class BasicProperty;
+
+public:
+    using ValueType = T;
+    using FuncType = F;
+
+    explicit ComputedBinding(F func) :
+        func(std::move(func)) { }
+
+private:
+    F func;
+};
+
+template <std::invocable F>
+auto computed(F&& f) {
+    return ComputedBinding<std::decay_t<std::invoke_result_t<F>>, std::decay_t<F>>(std::forward<F>(f));
+}
+
 template <typename T, bool Writable>
 class BasicProperty {
     friend class _Binding_Impl;
+    friend class ChangePoller;
     
     template <typename U, bool>
     friend class BasicProperty;
@@ -224,23 +727,64 @@ public:
     static constexpr bool IsWritable = Writable;
 
 private:
-    std::shared_ptr<DataType> data;
-    BindingNotifier binder;
+    // Everything beyond the plain value lives here and is only allocated once the
+    // property is bound, shared with a binding or observed. Until then the value
+    // is kept inline in m_value.
+    struct Extra {
+        std::shared_ptr<DataType> data;
+        BindingNotifier binder;
+        [[no_unique_address]] MetricToken<PropertyMetrics::Bound, Extra> counted;
+    };
+
+    // Owns the Extra once there is one. Until then the same word holds the
+    // epoch of the last write, tagged in the low bit, so a plain property has
+    // a version without growing.
+    class ExtraPtr {
+    public:
+        ExtraPtr() = default;
+        ExtraPtr(const ExtraPtr&) = delete;
+        ExtraPtr& operator=(const ExtraPtr&) = delete;
+        ~ExtraPtr() { delete get(); }
+
+        Extra* get() const { return m_bits & 1 ? nullptr : reinterpret_cast<Extra*>(m_bits); }
+        Extra* operator->() const { return get(); }
+        Extra& operator*() const { return *get(); }
+        explicit operator bool() const { return get() != nullptr; }
+
+        // Takes ownership of extra; a stamped version is dropped.
+        void reset(Extra* extra) {
+            delete get();
+            m_bits = reinterpret_cast<uintptr_t>(extra);
+        }
+
+        // Epoch stamped while there was no Extra, 0 if none.
+        uint64_t version() const { return m_bits & 1 ? m_bits >> 1 : 0; }
+
+        void stamp(uint64_t epoch) { m_bits = static_cast<uintptr_t>(epoch << 1 | 1); }
+
+    private:
+        uintptr_t m_bits = 0;
+    };
+
+    static_assert(sizeof(uintptr_t) >= sizeof(uint64_t), "ExtraPtr keeps an epoch in a pointer word");
+
+    mutable T m_value{};
+    mutable ExtraPtr m_extra;
+    [[no_unique_address]] MetricToken<PropertyMetrics::Properties> m_counted;
 
 public:
-    BasicProperty() :
-        data(std::make_shared<DataType>(T{})) { data->m_owner = this; }
+    BasicProperty() = default;
 
     BasicProperty(const T& value) :
-        data(std::make_shared<DataType>(value)) { data->m_owner = this; }
+        m_value(value) { }
 
     BasicProperty(T&& value) :
-        data(std::make_shared<DataType>(std::move(value))) { data->m_owner = this; }
+        m_value(std::move(value)) { }
 
     template <size_t N>
     requires std::same_as<std::string, T>
     BasicProperty(char const (&value)[N]) :
-        data(std::make_shared<DataType>(value)) { data->m_owner = this; }
+        m_value(value) { }
 
     template<IsProperty P>
     requires std::convertible_to<value_t<P>, T>
@@ -257,15 +801,49 @@ public:
         _Init_From_Binding(std::forward<B>(b));
     }
 
+    template <IsComputed C>
+    requires std::convertible_to<value_t<C>, T>
+    BasicProperty(C&& c) {
+        _Init_From_Computed(std::forward<C>(c));
+    }
+
     ~BasicProperty() {
-        freeze();
-        if(data->m_owner == this)
-            data->m_owner = nullptr;
+        if(hasData()) {
+            freeze();
+            releaseData();
+        }
     }
 
     // operator T() const { return value(); }
 
-    T value() const { return data->value(); }
+    T value() const {
+        if(DependencyTracker::active()) [[unlikely]]
+            DependencyTracker::record(getBinder());
+        if(hasData())
+            return m_extra->data->value();
+        return m_value;
+    }
+
+    // Read without copying when the value is stored; computed values are
+    // evaluated once into the returned guard.
+    ValueRef<T> ref() const {
+        if(DependencyTracker::active()) [[unlikely]]
+            DependencyTracker::record(getBinder());
+        if(hasData())
+            return m_extra->data->ref();
+        return ValueRef<T>(m_value);
+    }
+
+    // Epoch of the last change seen by this property (its own writes and
+    // upstream changes alike). Compare with ChangeEpoch::current() taken earlier.
+    // Plain properties keep the epoch of their last write without allocating.
+    uint64_t version() const { return m_extra ? m_extra->binder.version() : m_extra.version(); }
+
+    // True if the value comes from a binding or another property instead of
+    // being stored by this property.
+    bool isBound() const {
+        return hasData() && (m_extra->data->m_owner != this || !m_extra->data->isStored());
+    }
 
     BasicProperty<T, Writable>& operator=(const T& value) requires Writable {
         setValue(value);
@@ -287,99 +865,261 @@ public:
         if constexpr(std::is_rvalue_reference_v<decltype(prop)>) {
             _Init_Move(std::move(prop));
         } else {
-            binder.resetNotifier();
+            binder().resetNotifier();
             _Init_Copy(prop);
         }
-        binder.notify();
+        binder().notify();
         return *this;
     }
 
+    // A property that owns its data is rebound in place: dependents stay
+    // attached and only the upstream links that changed are touched. A binding
+    // that reads this property (directly or through its dependents) captured
+    // the current data, so it gets fresh data and the dependents are detached.
     template <IsPropertyBinding B>
     requires Writable && std::convertible_to<value_t<B>, T>
     BasicProperty<T, Writable>& operator=(B&& b) {
-        binder.resetNotifier();
-        _Init_From_Binding(std::forward<B>(b));
-        binder.notify();
+        if(hasData() && m_extra->data->m_owner == this && !m_extra->binder.reaches(b.notifiers)) {
+            if constexpr(std::is_rvalue_reference_v<decltype(b)>)
+                m_extra->data->setValue(std::move(b.func));
+            else
+                m_extra->data->setValue(b.func);
+            m_extra->binder.rebind(b.notifiers);
+        } else {
+            binder().resetNotifier();
+            _Init_From_Binding(std::forward<B>(b));
+        }
+        binder().notify();
+        return *this;
+    }
+
+    template <IsComputed C>
+    requires Writable && std::convertible_to<value_t<C>, T>
+    BasicProperty<T, Writable>& operator=(C&& c) {
+        _Init_From_Computed(std::forward<C>(c));
+        binder().notify();
         return *this;
     }
 
     template <std::convertible_to<T> VT>
     void setValue(VT&& value) requires Writable {
-        if(data->m_owner == this)
-            data->setValue(std::forward<VT>(value));
-        else {
-            binder.resetNotifier();
-            data = std::make_shared<DataType>(std::forward<VT>(value));
-            data->m_owner = this;
+        PropertyMetrics::count(PropertyMetrics::Writes);
+        if(PropertyTracer::current()) [[unlikely]] {
+            uint64_t fired = BindingNotifier::firedCount();
+            uint64_t begin = PropertyTracer::now();
+            assign(std::forward<VT>(value));
+            PropertyTracer::dispatch(this, begin, PropertyTracer::now() - begin, static_cast<uint32_t>(BindingNotifier::firedCount() - fired));
+        } else {
+            assign(std::forward<VT>(value));
         }
-        binder.notify();
     }
 
     template <std::invocable F>
-    void onValueChanged(F&& f) {
-        binder.addObserver(std::forward<F>(f));
+    void onValueChanged(F&& f) const {
+        binder().addObserver(std::forward<F>(f));
+    }
+
+    template <std::invocable<const T&> F>
+    void onValueChanged(F&& f) const {
+        binder().addObserver([func = std::forward<F>(f), this] { func(*ref()); });
+    }
+
+    template <std::invocable F>
+    void onValueChanged(ObserverPriority priority, F&& f) const {
+        binder().addObserver(std::forward<F>(f), priority);
     }
 
-    template <std::invocable<T> F>
-    void onValueChanged(F&& f) {
-        binder.addObserver([func = std::forward<F>(f), this] { func(value()); });
+    template <std::invocable<const T&> F>
+    void onValueChanged(ObserverPriority priority, F&& f) const {
+        binder().addObserver([func = std::forward<F>(f), this] { func(*ref()); }, priority);
     }
 
     template <class C, std::invocable F>
-    requires SameAs<C, BindingContext, std::weak_ptr<void>>
-    void onValueChanged(C&& context, F&& f) {
-        binder.addObserver(context, std::forward<F>(f));
+    requires SameAs<std::decay_t<C>, BindingContext, std::weak_ptr<void>>
+    void onValueChanged(C&& context, F&& f) const {
+        binder().addObserver(context, std::forward<F>(f));
+    }
+
+    template <class C, std::invocable<const T&> F>
+    requires SameAs<std::decay_t<C>, BindingContext, std::weak_ptr<void>>
+    void onValueChanged(C&& context, F&& f) const {
+        binder().addObserver(context, [func = std::forward<F>(f), this] { func(*ref()); });
+    }
+
+    template <std::invocable F>
+    Connection connect(F&& f, ObserverPriority priority = ObserverPriority::Normal) const {
+        return binder().connect(std::forward<F>(f), priority);
     }
 
-    template <class C, std::invocable<T> F>
-    requires SameAs<C, BindingContext, std::weak_ptr<void>>
-    void onValueChanged(C&& context, F&& f) {
-        binder.addObserver(context, [func = std::forward<F>(f), this] { func(value()); });
+    template <std::invocable<const T&> F>
+    Connection connect(F&& f, ObserverPriority priority = ObserverPriority::Normal) const {
+        return binder().connect([func = std::forward<F>(f), this] { func(*ref()); }, priority);
     }
 
 private:
-    BindingNotifier* getBinder() const { return const_cast<BindingNotifier*>(&binder); }
+    Extra& extra() const {
+        if(!m_extra) {
+            uint64_t version = m_extra.version();
+            m_extra.reset(new Extra);
+            m_extra->binder.m_version = version;
+        }
+        return *m_extra;
+    }
+
+    bool hasData() const { return m_extra && m_extra->data; }
+
+    BindingNotifier& binder() const { return extra().binder; }
+
+    BindingNotifier* getBinder() const { return &extra().binder; }
+
+    // Moves an inline value into shared PropertyData so bindings can capture it.
+    std::shared_ptr<DataType>& sharedData() const {
+        auto& e = extra();
+        if(!e.data) {
+            e.data = std::make_shared<DataType>(std::move(m_value));
+            e.data->m_owner = const_cast<BasicProperty*>(this);
+        }
+        return e.data;
+    }
+
+    // Writing the value a source already holds is not a change: nothing is
+    // notified and no version is bumped.
+    template <class VT>
+    void assign(VT&& value) {
+        if constexpr(std::equality_comparable<T>) {
+            if constexpr(std::same_as<std::decay_t<VT>, T>) {
+                const T* current = storedValue();
+                if(current && *current == value)
+                    return;
+            } else {
+                assign(T(std::forward<VT>(value)));
+                return;
+            }
+        }
+        if(!hasData())
+            m_value = std::forward<VT>(value);
+        else if(m_extra->data->m_owner == this) {
+            if(!m_extra->data->isStored())
+                m_extra->binder.unbind();
+            m_extra->data->setValue(std::forward<VT>(value));
+        } else {
+            m_extra->binder.resetNotifier();
+            m_extra->data.reset();
+            m_value = std::forward<VT>(value);
+        }
+        if(m_extra)
+            m_extra->binder.notify();
+        else
+            m_extra.stamp(ChangeEpoch::next());
+    }
+
+    // The value this property stores itself, nullptr if it is bound or an alias.
+    const T* storedValue() const {
+        if(!hasData())
+            return &m_value;
+        const auto& data = m_extra->data;
+        return data->m_owner == this && data->isStored() ? data->peek() : nullptr;
+    }
+
+    void releaseData() {
+        if(m_extra->data->m_owner == this)
+            m_extra->data->m_owner = nullptr;
+        m_extra->data.reset();
+    }
 
     template<typename P>
     inline void _Init_Copy(const P& prop) {
         const_cast<P*>(&prop)->unshare_data();
+        if(hasData())
+            releaseData();
         if constexpr(std::is_same_v<std::decay_t<T>, value_t<P>>) {
-            data = prop.data;
+            extra().data = prop.m_extra->data;
         } else {
-            data = std::make_shared<DataType>([data = prop.data] { return data->value(); });
-            data->m_owner = this;
+            extra().data = std::make_shared<DataType>([data = prop.m_extra->data]() -> T { return *data->ref(); });
+            m_extra->data->m_owner = this;
         }
-        binder.binding(const_cast<BindingNotifier*>(&prop.binder));
+        binder().binding(prop.getBinder());
     }
 
     template<typename P>
     inline void _Init_Move(P&& prop) {
-        if constexpr(std::is_same_v<std::decay_t<T>, value_t<P>>)
-            data = std::move(prop.data);
-        else
-            data = std::make_shared<DataType>([data = std::move(prop.data)] { return data->value(); });
-        data->m_owner = this;
+        if(hasData())
+            releaseData();
+        if(!prop.hasData()) {
+            m_value = std::move(prop.m_value);
+            return;
+        }
+        auto& data = prop.m_extra->data;
+        if constexpr(std::is_same_v<std::decay_t<T>, value_t<P>>) {
+            if(data->m_owner == &prop)
+                data->m_owner = this;
+            extra().data = std::move(data);
+        } else {
+            extra().data = std::make_shared<DataType>([data = std::move(data)]() -> T { return *data->ref(); });
+            m_extra->data->m_owner = this;
+        }
     }
 
     template <typename B>
     inline void _Init_From_Binding(B&& b) {
+        if(hasData())
+            releaseData();
         if constexpr(std::is_rvalue_reference_v<decltype(b)>)
-            data = std::make_shared<DataType>(std::move(b.func));
+            extra().data = std::make_shared<DataType>(std::move(b.func));
         else
-            data = std::make_shared<DataType>(b.func);
-        data->m_owner = this;
-        binder.binding(b.notifiers);
+            extra().data = std::make_shared<DataType>(b.func);
+        m_extra->data->m_owner = this;
+        binder().binding(b.notifiers);
+    }
+
+    // Owned data is rebound in place like for PropertyBinding. Besides the
+    // tracking functor, an Immediate observer re-evaluates the data on every
+    // wave that reaches it, so an input read only by a newly taken branch is
+    // subscribed before it can change. The observer goes away with the next
+    // setValue on the data.
+    template <typename C>
+    inline void _Init_From_Computed(C&& c) {
+        bool inPlace = hasData() && m_extra->data->m_owner == this;
+        if(hasData() && !inPlace) {
+            m_extra->binder.resetNotifier();
+            releaseData();
+        }
+        auto func = binder().tracking(std::forward<C>(c).func);
+        if(inPlace) {
+            m_extra->data->setValue(std::move(func));
+        } else {
+            m_extra->data = std::make_shared<DataType>(std::move(func));
+            m_extra->data->m_owner = this;
+        }
+        auto& data = m_extra->data;
+        m_extra->binder.observers(ObserverPriority::Immediate).push_back({[weak = std::weak_ptr<DataType>(data), version = data->version()] {
+            auto d = weak.lock();
+            if(!d || d->version() != version)
+                return true;
+            d->value();
+            return false;
+        }});
+        data->value();
     }
 
     inline void unshare_data() {
+        auto& data = sharedData();
         if(data->m_owner != this) {
-            data = std::make_shared<DataType>([v = data] { return v->value(); });
+            data = DataType::alias(data);
             data->m_owner = this;
         }
     }
 
+    // Whoever else holds the data keeps the value it had when this property
+    // died. Stored values need no snapshot, and data nobody else holds is
+    // simply dropped.
     inline void freeze() {
-        if(data->m_owner == this)
+        auto& data = m_extra->data;
+        if(data->m_owner != this || data->isStored() || data.use_count() == 1)
+            return;
+        if(PropertyTeardown::active())
+            PropertyTeardown::defer(data);
+        else
             data->setValue(data->value());
     }
 };
@@ -390,6 +1130,34 @@ using property = BasicProperty<T, true>;
 template <typename T>
 using readonly = BasicProperty<T, false>;
 
+// The common value types are instantiated once, in Property.cpp.
+extern template class PropertyData<bool>;
+extern template class OneValue<bool>;
+extern template class BasicProperty<bool, true>;
+extern template class BasicProperty<bool, false>;
+extern template class PropertyData<int>;
+extern template class OneValue<int>;
+extern template class BasicProperty<int, true>;
+extern template class BasicProperty<int, false>;
+extern template class PropertyData<double>;
+extern template class OneValue<double>;
+extern template class BasicProperty<double, true>;
+extern template class BasicProperty<double, false>;
+extern template class PropertyData<std::string>;
+extern template class OneValue<std::string>;
+extern template class BasicProperty<std::string, true>;
+extern template class BasicProperty<std::string, false>;
+
+// Size budget of a property that is neither bound nor observed: the value itself
+// (padded to pointer alignment) plus the pointer to the lazily allocated state.
+template <typename T>
+inline constexpr size_t property_size_budget = (sizeof(T) + alignof(void*) - 1) / alignof(void*) * alignof(void*) + sizeof(void*);
+
+static_assert(sizeof(property<bool>) <= property_size_budget<bool>);
+static_assert(sizeof(property<int>) <= property_size_budget<int>);
+static_assert(sizeof(property<double>) <= property_size_budget<double>);
+static_assert(sizeof(property<std::string>) <= property_size_budget<std::string>);
+
 
 struct _Binding_Impl {
     template <class T, typename F>
@@ -405,7 +1173,7 @@ struct _Binding_Impl {
 
     template <typename O, IsProperty P, IsNotPB V>
     static inline auto createBinaery(const P& prop, V&& value) {
-        PropertyBinding binding{[data = prop.data, v = std::forward<V>(value)] { return O::calc(data->value(), v); }};
+        PropertyBinding binding{[data = prop.sharedData(), v = std::forward<V>(value)] { return O::calc(*data->ref(), v); }};
         binding.addNotifier(prop.getBinder());
         return binding;
     }
@@ -419,7 +1187,7 @@ struct _Binding_Impl {
 
     template <typename O, IsPropertyBinding U, IsProperty P>
     static inline auto createBinaery(U&& binding, const P& prop) {
-        PropertyBinding b{[func = getData(std::forward<U>(binding)), rv = prop.data] { return O::calc(func(), rv->value()); }};
+        PropertyBinding b{[func = getData(std::forward<U>(binding)), rv = prop.sharedData()] { return O::calc(func(), *rv->ref()); }};
         b.mergeNotifiers(binding.notifiers);
         b.addNotifier(prop.getBinder());
         return b;
@@ -432,7 +1200,7 @@ struct _Binding_Impl {
     template <typename O, IsProperty P1, IsProperty P2>
     requires CanBeCalc<O, value_t<P1>, value_t<P2>>
     static inline auto Operator(const P1& a, const P2& b) {
-        PropertyBinding binding{[pa = a.data, pb = b.data] { return O::calc(pa->value(), pb->value()); }};
+        PropertyBinding binding{[pa = a.sharedData(), pb = b.sharedData()] { return O::calc(*pa->ref(), *pb->ref()); }};
         binding.addNotifier(a.getBinder());
         binding.addNotifier(b.getBinder());
         return binding;
@@ -490,7 +1258,7 @@ struct _Binding_Impl {
     template <typename O, IsProperty P>
     requires CanBeCalcOne<O, value_t<P>>
     static inline auto Operator(const P& prop) {
-        PropertyBinding b{[v = prop.data]() { return O::calc(v->value()); }};
+        PropertyBinding b{[v = prop.sharedData()]() { return O::calc(*v->ref()); }};
         b.addNotifier(prop.getBinder());
         return b;
     }
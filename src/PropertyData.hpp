@@ -1,16 +1,31 @@
 #pragma once
+#include <atomic>
 #include <concepts>
 #include <cstddef>
 #include <functional>
 #include <list>
 #include <memory>
+#include <optional>
 #include <utility>
 #include <vector>
-#include <iostream>
+
+#include "Metrics.hpp"
 
 template <typename T>
 class PropertyData;
 
+// Global change counter. Versions are epochs taken from it, so one stored
+// epoch can be compared against any number of properties, also by a consumer
+// polling from another thread or PropertyDomain.
+class ChangeEpoch {
+public:
+    static uint64_t current() { return s_epoch.load(std::memory_order_relaxed); }
+    static uint64_t next() { return s_epoch.fetch_add(1, std::memory_order_relaxed) + 1; }
+
+private:
+    inline static std::atomic<uint64_t> s_epoch = 0;
+};
+
 template <class T>
 using SharedDataType = std::shared_ptr<PropertyData<T>>;
 
@@ -19,6 +34,36 @@ class BasicValue {
 public:
     virtual ~BasicValue() { }
     virtual T value() const = 0;
+
+    // Address of the stored value if there is one, nullptr for computed values.
+    virtual const T* peek() const { return nullptr; }
+};
+
+// ValueRef is a read guard: it refers to a stored value in place and only owns
+// a temporary when the value had to be computed. Keep it no longer than the full
+// expression or scope that reads it; a setValue on the source invalidates it.
+template <class T>
+class ValueRef {
+public:
+    explicit ValueRef(const T& ref) :
+        m_ptr(&ref) { }
+
+    explicit ValueRef(T&& value) :
+        m_owned(std::move(value)), m_ptr(&*m_owned) { }
+
+    ValueRef(const ValueRef&) = delete;
+    ValueRef& operator=(const ValueRef&) = delete;
+
+    const T& get() const { return *m_ptr; }
+    const T& operator*() const { return *m_ptr; }
+    const T* operator->() const { return m_ptr; }
+    operator const T&() const { return *m_ptr; }
+
+    bool owned() const { return m_owned.has_value(); }
+
+private:
+    std::optional<T> m_owned;
+    const T* m_ptr;
 };
 
 template <class T, class D = T, class Operator = Noop>
@@ -32,6 +77,16 @@ public:
 
     T value() const override { return Operator::calc(data); }
 
+    const T* peek() const override {
+        if constexpr(std::is_same_v<T, D> && std::is_same_v<Operator, Noop>)
+            return &data;
+        else
+            return nullptr;
+    }
+
+    template <class U>
+    void set(U&& v) { data = std::forward<U>(v); }
+
 private:
     D data;
 };
@@ -47,10 +102,39 @@ public:
 
     T value() const override { return Operator::calc(data->value()); }
 
+    const T* peek() const override {
+        if constexpr(std::is_same_v<Operator, Noop>)
+            return data->peek();
+        else
+            return nullptr;
+    }
+
 private:
     SharedDataType<T> data;
 };
 
+// The value of an alias: data forwarding to the data of another property. It
+// reads the root of the alias chain directly and keeps the data it was made
+// from alive, so that the chain can be re-rooted if that data stops being an
+// alias itself (see PropertyData::alias).
+template <class T>
+class AliasValue : public BasicValue<T> {
+    friend class PropertyData<T>;
+
+public:
+    AliasValue(SharedDataType<T> parent, SharedDataType<T> root) :
+        parent(std::move(parent)), root(std::move(root)) { }
+
+    T value() const override { return root->value(); }
+
+    const T* peek() const override { return root->peek(); }
+
+private:
+    SharedDataType<T> parent;
+    SharedDataType<T> root; // nearest data up the chain that is not an alias
+    std::vector<std::weak_ptr<PropertyData<T>>> followers; // aliases made from this one
+};
+
 // ========================================================
 
 template <class T, class Left, class Right, class Operator>
@@ -144,14 +228,10 @@ class PropertyData {
 
 public:
     PropertyData(const T& value) :
-        m_data(new OneValue<T>{value}) {
-        std::cout << " cc-------> " << this << " " << value << std::endl;
-    }
+        m_data(new OneValue<T>{value}), m_stored(true) { }
 
     PropertyData(T&& value) :
-        m_data(new OneValue<T>{std::move(value)}) {
-        std::cout << " mm-------> " << this << " " << value << std::endl;
-    }
+        m_data(new OneValue<T>{std::move(value)}), m_stored(true) { }
 
     PropertyData(const PropertyData<T>& o) = delete;
 
@@ -159,38 +239,101 @@ public:
 
     template <std::invocable F>
     PropertyData(F&& func) :
-        m_data(new FunctorValue<T, F>{std::forward<F>(func)}) {
-        std::cout << " func-------> " << this << " " << m_data->value() << std::endl;
-    }
+        m_data(new FunctorValue<T, std::decay_t<F>>{std::decay_t<F>(std::forward<F>(func))}) { }
 
     PropertyData(BasicValue<T>* value) :
-        m_data(value) {
-        std::cout << " BasicValue<T>* -------> " << this << " " << value << std::endl;
-    }
+        m_data(value), m_stored(dynamic_cast<OneValue<T>*>(value) != nullptr) { }
 
     ~PropertyData() {
         if(m_data)
             delete m_data;
-        std::cout << " delete-------> " << this << std::endl;
     }
 
     T value() const { return m_data->value(); }
 
+    const T* peek() const { return m_data->peek(); }
+
+    bool isStored() const { return m_stored; }
+
+    bool isAlias() const { return m_alias; }
+
+    // Data forwarding to parent. An alias of an alias forwards to the root of
+    // the chain, and is re-rooted if one of the aliases in between gets a value
+    // of its own, so reads cost the same however often a property is passed on.
+    static std::shared_ptr<PropertyData> alias(const std::shared_ptr<PropertyData>& parent) {
+        auto* from = parent->m_alias ? static_cast<AliasValue<T>*>(parent->m_data) : nullptr;
+        auto data = std::make_shared<PropertyData>(new AliasValue<T>(parent, from ? from->root : parent));
+        data->m_alias = true;
+        if(from) {
+            std::erase_if(from->followers, [](const auto& f) { return f.expired(); });
+            from->followers.push_back(data);
+        }
+        return data;
+    }
+
+    ValueRef<T> ref() const {
+        if(const T* p = m_data->peek())
+            return ValueRef<T>(*p);
+        return ValueRef<T>(m_data->value());
+    }
+
+    // A stored value is assigned in place; only replacing a computed value
+    // allocates.
     template <std::convertible_to<T> U>
     void setValue(U&& value) {
-        if(m_data)
-            delete m_data;
-        m_data = new OneValue<T>{std::forward<U>(value)};
+        if(m_stored) {
+            static_cast<OneValue<T>*>(m_data)->set(std::forward<U>(value));
+        } else {
+            if(m_alias)
+                unalias();
+            if(m_data)
+                delete m_data;
+            m_data = new OneValue<T>{T(std::forward<U>(value))};
+            m_stored = true;
+        }
+        m_version = ChangeEpoch::next();
     }
 
     template <std::invocable F>
     void setValue(F&& func) {
+        BasicValue<T>* data = new FunctorValue<T, std::decay_t<F>>{std::decay_t<F>(std::forward<F>(func))};
+        if(m_alias)
+            unalias();
         if(m_data)
             delete m_data;
-        m_data = new FunctorValue<T, F>{std::forward<F>(func)};
+        m_data = data;
+        m_stored = false;
+        m_version = ChangeEpoch::next();
     }
 
+    // Epoch of the last setValue; computed data does not track its inputs.
+    uint64_t version() const { return m_version; }
+
 private:
+    // Called before an alias gets a value of its own: the aliases made from it
+    // now forward to it rather than to the old root. Followers that got values
+    // of their own in the meantime are skipped.
+    void unalias() {
+        for(auto& f : static_cast<AliasValue<T>*>(m_data)->followers) {
+            if(auto follower = f.lock(); follower && follower->m_alias)
+                follower->reroot(static_cast<AliasValue<T>*>(follower->m_data)->parent);
+        }
+        m_alias = false;
+    }
+
+    void reroot(const std::shared_ptr<PropertyData>& root) {
+        auto* node = static_cast<AliasValue<T>*>(m_data);
+        node->root = root;
+        for(auto& f : node->followers) {
+            if(auto follower = f.lock(); follower && follower->m_alias)
+                follower->reroot(root);
+        }
+    }
+
     BasicValue<T>* m_data;
+    bool m_stored = false; // m_data is a plain OneValue<T>
+    bool m_alias = false;  // m_data is an AliasValue<T>
     void* m_owner = nullptr;
+    uint64_t m_version = 0;
+    [[no_unique_address]] MetricToken<PropertyMetrics::Data, PropertyData> m_counted;
 };
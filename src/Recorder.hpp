@@ -0,0 +1,216 @@
+#pragma once
+
+#include <algorithm>
+#include <bit>
+
+#include "Snapshot.hpp"
+
+// One recorded write. Values up to sizeof(payload) bytes are stored inline;
+// longer values are cut and flagged Truncated, and are skipped on replay.
+struct ChangeEvent {
+    enum Flags : uint16_t {
+        Truncated = 1
+    };
+
+    uint64_t time;          // steady clock ns when the write started
+    uint64_t key;           // PropertySnapshot::key of the tracked name
+    uint64_t propagationNs; // time spent assigning and propagating
+    uint32_t fired;         // notifiers fired by the write
+    uint16_t size;
+    uint16_t flags;
+    std::byte payload[32];
+};
+
+static_assert(sizeof(ChangeEvent) == 64 && std::is_trivially_copyable_v<ChangeEvent>);
+
+// ChangeRecorder keeps the most recent writes to tracked properties in a
+// fixed-size ring. Writers on any thread claim a slot with one fetch_add and
+// publish it through a per-slot sequence number, so recording never blocks
+// and events() can copy a consistent view while writes continue.
+// Register properties with track() before start().
+class ChangeRecorder : public PropertyTracer {
+public:
+    static constexpr char Magic[4] = {'P', 'B', 'R', 'C'};
+    static constexpr uint32_t Version = 1;
+
+    explicit ChangeRecorder(size_t capacity = 1 << 16) :
+        m_slots(std::bit_ceil(std::max<size_t>(capacity, 2))), m_mask(m_slots.size() - 1) { }
+
+    ChangeRecorder(const ChangeRecorder&) = delete;
+    ChangeRecorder& operator=(const ChangeRecorder&) = delete;
+
+    ~ChangeRecorder() { stop(); }
+
+    template <class T, bool W>
+    void track(std::string_view name, const BasicProperty<T, W>& prop) {
+        m_tracked[&prop] = {PropertySnapshot::key(name), [&prop](ChangeEvent& e) { encode(*prop.ref(), e); }};
+    }
+
+    // Starting a started recorder does nothing. Recorders may be stopped and
+    // destroyed in any order; other installed tracers keep tracing.
+    void start() { PropertyTracer::install(this); }
+
+    void stop() { PropertyTracer::uninstall(this); }
+
+    void onSetValue(const void* property, uint64_t timeNs, uint64_t propagationNs, uint32_t fired) override {
+        auto it = m_tracked.find(property);
+        if(it != m_tracked.end())
+            append(it->second, timeNs, propagationNs, fired);
+    }
+
+    // Events still in the ring, oldest first.
+    std::vector<ChangeEvent> events() const {
+        uint64_t head = m_head.load(std::memory_order_acquire);
+        uint64_t first = head > m_slots.size() ? head - m_slots.size() : 0;
+        std::vector<ChangeEvent> out;
+        out.reserve(head - first);
+        for(uint64_t pos = first; pos < head; ++pos) {
+            const Slot& slot = m_slots[pos & m_mask];
+            if(slot.seq.load(std::memory_order_acquire) != 2 * pos + 2)
+                continue;
+            ChangeEvent e = slot.event;
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(slot.seq.load(std::memory_order_relaxed) == 2 * pos + 2)
+                out.push_back(e);
+        }
+        return out;
+    }
+
+    // Events overwritten before anyone read them.
+    uint64_t dropped() const {
+        uint64_t head = m_head.load(std::memory_order_relaxed);
+        return head > m_slots.size() ? head - m_slots.size() : 0;
+    }
+
+    bool dump(const std::string& path) const {
+        auto list = events();
+        uint32_t header[4] = {0, Version, static_cast<uint32_t>(list.size()), sizeof(ChangeEvent)};
+        std::memcpy(header, Magic, sizeof(Magic));
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(header), sizeof(header));
+        file.write(reinterpret_cast<const char*>(list.data()), static_cast<std::streamsize>(list.size() * sizeof(ChangeEvent)));
+        return file.good();
+    }
+
+    static std::vector<ChangeEvent> load(const std::string& path) {
+        std::ifstream file(path, std::ios::binary);
+        uint32_t header[4] = {};
+        if(!file.read(reinterpret_cast<char*>(header), sizeof(header)))
+            return {};
+        if(std::memcmp(header, Magic, sizeof(Magic)) != 0 || header[1] != Version || header[3] != sizeof(ChangeEvent))
+            return {};
+        std::vector<ChangeEvent> list(header[2]);
+        if(!file.read(reinterpret_cast<char*>(list.data()), static_cast<std::streamsize>(list.size() * sizeof(ChangeEvent))))
+            return {};
+        return list;
+    }
+
+private:
+    struct Track {
+        uint64_t key;
+        std::function<void(ChangeEvent&)> encode;
+    };
+
+    struct Slot {
+        std::atomic<uint64_t> seq{0};
+        ChangeEvent event;
+    };
+
+    template <class T>
+    static void encode(const T& value, ChangeEvent& e) {
+        if constexpr(std::is_trivially_copyable_v<T> && sizeof(T) <= sizeof(e.payload)) {
+            std::memcpy(e.payload, &value, sizeof(T));
+            e.size = sizeof(T);
+        } else {
+            thread_local std::vector<std::byte> buffer;
+            buffer.clear();
+            SnapshotCodec<T>::encode(value, buffer);
+            e.size = static_cast<uint16_t>(std::min(buffer.size(), sizeof(e.payload)));
+            std::memcpy(e.payload, buffer.data(), e.size);
+            if(buffer.size() > sizeof(e.payload))
+                e.flags |= ChangeEvent::Truncated;
+        }
+    }
+
+    void append(const Track& track, uint64_t timeNs, uint64_t propagationNs, uint32_t fired) {
+        uint64_t pos = m_head.fetch_add(1, std::memory_order_relaxed);
+        Slot& slot = m_slots[pos & m_mask];
+        slot.seq.store(2 * pos + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        ChangeEvent& e = slot.event;
+        e = {timeNs, track.key, propagationNs, fired, 0, 0, {}};
+        track.encode(e);
+        slot.seq.store(2 * pos + 2, std::memory_order_release);
+    }
+
+    std::vector<Slot> m_slots;
+    const uint64_t m_mask;
+    std::atomic<uint64_t> m_head{0};
+    std::unordered_map<const void*, Track> m_tracked;
+};
+
+struct ReplayReport {
+    struct Event {
+        uint64_t key;
+        uint64_t propagationNs;
+        uint32_t fired;
+    };
+
+    std::vector<Event> events;
+    size_t skipped = 0; // unknown property or truncated value
+    uint64_t totalNs = 0;
+
+    // Propagation cost at quantile q (0..1) over the applied events.
+    uint64_t percentile(double q) const {
+        if(events.empty())
+            return 0;
+        std::vector<uint64_t> ns;
+        ns.reserve(events.size());
+        for(const auto& e : events)
+            ns.push_back(e.propagationNs);
+        size_t i = std::min(ns.size() - 1, static_cast<size_t>(q * static_cast<double>(ns.size())));
+        std::nth_element(ns.begin(), ns.begin() + static_cast<std::ptrdiff_t>(i), ns.end());
+        return ns[i];
+    }
+};
+
+// ChangeReplayer applies a recorded stream to a rebuilt graph in recorded
+// order, as fast as possible, and measures what each write costs there.
+class ChangeReplayer {
+public:
+    template <class T>
+    void add(std::string_view name, property<T>& prop) {
+        m_targets[PropertySnapshot::key(name)] = [&prop](const ChangeEvent& e) {
+            T value{};
+            if(!SnapshotCodec<T>::decode(std::span(e.payload, e.size), value))
+                return false;
+            prop.setValue(std::move(value));
+            return true;
+        };
+    }
+
+    ReplayReport replay(std::span<const ChangeEvent> events) const {
+        ReplayReport report;
+        report.events.reserve(events.size());
+        for(const auto& e : events) {
+            auto it = m_targets.find(e.key);
+            if(it == m_targets.end() || (e.flags & ChangeEvent::Truncated)) {
+                ++report.skipped;
+                continue;
+            }
+            uint64_t fired = BindingNotifier::firedCount();
+            uint64_t begin = PropertyTracer::now();
+            if(!it->second(e)) {
+                ++report.skipped;
+                continue;
+            }
+            uint64_t ns = PropertyTracer::now() - begin;
+            report.totalNs += ns;
+            report.events.push_back({e.key, ns, static_cast<uint32_t>(BindingNotifier::firedCount() - fired)});
+        }
+        return report;
+    }
+
+private:
+    std::unordered_map<uint64_t, std::function<bool(const ChangeEvent&)>> m_targets;
+};
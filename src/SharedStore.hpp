@@ -0,0 +1,336 @@
+#pragma once
+
+#if defined(__linux__)
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include <thread>
+
+#include "Snapshot.hpp"
+
+// Region layout, all in native byte order:
+//   SharedStoreHeader
+//   epoch table, one std::atomic<uint64_t> per slot
+//   slots, each a SharedSlot followed by slotSize bytes of value, 64-byte aligned
+// The epoch table is kept apart from the slots so a reader polling for changes
+// scans one dense array instead of touching every slot's cache line.
+struct SharedStoreHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t slotCount;
+    uint32_t slotSize;
+    std::atomic<uint32_t> used; // slots registered so far, grows only
+    uint32_t reserved;
+    std::atomic<uint64_t> epoch; // epoch of the latest write to any slot
+};
+
+// seq is a seqlock: odd while the writer copies the value in.
+struct SharedSlot {
+    std::atomic<uint64_t> seq;
+    uint64_t key;  // PropertySnapshot::key of the published name
+    uint32_t size; // sizeof the published type
+    uint32_t reserved;
+};
+
+static_assert(std::atomic<uint64_t>::is_always_lock_free && std::atomic<uint32_t>::is_always_lock_free,
+              "shared slots rely on address-free atomics");
+static_assert(sizeof(SharedStoreHeader) == 32 && sizeof(SharedSlot) == 24);
+
+// Owns one mapping of a POSIX shared-memory object.
+class SharedRegion {
+public:
+    SharedRegion() = default;
+    SharedRegion(const SharedRegion&) = delete;
+    SharedRegion& operator=(const SharedRegion&) = delete;
+
+    SharedRegion(SharedRegion&& o) noexcept :
+        m_base(std::exchange(o.m_base, nullptr)), m_size(std::exchange(o.m_size, 0)), m_name(std::move(o.m_name)),
+        m_owner(std::exchange(o.m_owner, false)) { }
+
+    SharedRegion& operator=(SharedRegion&& o) noexcept {
+        std::swap(m_base, o.m_base);
+        std::swap(m_size, o.m_size);
+        std::swap(m_name, o.m_name);
+        std::swap(m_owner, o.m_owner);
+        return *this;
+    }
+
+    ~SharedRegion() {
+        if(m_base)
+            munmap(m_base, m_size);
+        if(m_owner)
+            shm_unlink(m_name.c_str());
+    }
+
+    // Creates (or replaces) the object; it is unlinked again when this dies.
+    static SharedRegion create(const std::string& name, size_t size) {
+        SharedRegion region;
+        shm_unlink(name.c_str());
+        int fd = shm_open(name.c_str(), O_CREAT | O_EXCL | O_RDWR, 0600);
+        if(fd < 0)
+            return region;
+        if(ftruncate(fd, static_cast<off_t>(size)) == 0)
+            region.map(fd, size, PROT_READ | PROT_WRITE);
+        close(fd);
+        if(region.m_base) {
+            region.m_name = name;
+            region.m_owner = true;
+        } else {
+            shm_unlink(name.c_str());
+        }
+        return region;
+    }
+
+    static SharedRegion open(const std::string& name) {
+        SharedRegion region;
+        int fd = shm_open(name.c_str(), O_RDONLY, 0);
+        if(fd < 0)
+            return region;
+        struct stat st{};
+        if(fstat(fd, &st) == 0 && st.st_size > 0)
+            region.map(fd, static_cast<size_t>(st.st_size), PROT_READ);
+        close(fd);
+        return region;
+    }
+
+    explicit operator bool() const { return m_base != nullptr; }
+    std::byte* data() const { return static_cast<std::byte*>(m_base); }
+    size_t size() const { return m_size; }
+
+private:
+    void map(int fd, size_t size, int prot) {
+        void* p = mmap(nullptr, size, prot, MAP_SHARED, fd, 0);
+        if(p != MAP_FAILED) {
+            m_base = p;
+            m_size = size;
+        }
+    }
+
+    void* m_base = nullptr;
+    size_t m_size = 0;
+    std::string m_name;
+    bool m_owner = false;
+};
+
+// Addressing shared by the writer and the readers.
+class SharedStoreLayout {
+public:
+    static constexpr char Magic[4] = {'P', 'B', 'S', 'M'};
+    static constexpr uint32_t Version = 1;
+
+    static size_t stride(uint32_t slotSize) { return (sizeof(SharedSlot) + slotSize + 63) & ~size_t(63); }
+
+    static size_t slotsOffset(uint32_t slotCount) {
+        return (sizeof(SharedStoreHeader) + slotCount * sizeof(uint64_t) + 63) & ~size_t(63);
+    }
+
+    static size_t regionSize(uint32_t slotCount, uint32_t slotSize) {
+        return slotsOffset(slotCount) + slotCount * stride(slotSize);
+    }
+
+protected:
+    SharedStoreHeader* header() const { return reinterpret_cast<SharedStoreHeader*>(m_region.data()); }
+
+    std::atomic<uint64_t>* epochs() const {
+        return reinterpret_cast<std::atomic<uint64_t>*>(m_region.data() + sizeof(SharedStoreHeader));
+    }
+
+    SharedSlot* slot(size_t i) const {
+        const SharedStoreHeader* h = header();
+        return reinterpret_cast<SharedSlot*>(m_region.data() + slotsOffset(h->slotCount) + i * stride(h->slotSize));
+    }
+
+    static std::byte* payload(SharedSlot* s) { return reinterpret_cast<std::byte*>(s + 1); }
+
+    SharedRegion m_region;
+};
+
+// SharedPropertyStore is the writing side: it owns the region and mirrors each
+// published property into its slot on every change, stamping the slot's entry
+// in the epoch table. One writer process per store.
+class SharedPropertyStore : public SharedStoreLayout {
+public:
+    SharedPropertyStore(const std::string& name, uint32_t slotCount = 256, uint32_t slotSize = 64) {
+        m_region = SharedRegion::create(name, regionSize(slotCount, slotSize));
+        if(!m_region)
+            return;
+        auto* h = new(m_region.data()) SharedStoreHeader{{}, Version, slotCount, slotSize, {0}, 0, {0}};
+        std::memcpy(h->magic, Magic, sizeof(Magic));
+        for(uint32_t i = 0; i < slotCount; ++i) {
+            new(epochs() + i) std::atomic<uint64_t>(0);
+            new(slot(i)) SharedSlot{{0}, 0, 0, 0};
+        }
+    }
+
+    // Published properties call back into the store.
+    SharedPropertyStore(SharedPropertyStore&&) = delete;
+
+    explicit operator bool() const { return static_cast<bool>(m_region); }
+
+    // Returns the slot index, or -1 if the store is full, unavailable, or T
+    // does not fit in a slot.
+    template <class T, bool W>
+    requires std::is_trivially_copyable_v<T>
+    int publish(std::string_view name, const BasicProperty<T, W>& prop) {
+        if(!m_region || sizeof(T) > header()->slotSize)
+            return -1;
+        uint32_t i = header()->used.load(std::memory_order_relaxed);
+        if(i == header()->slotCount)
+            return -1;
+        SharedSlot* s = slot(i);
+        s->key = PropertySnapshot::key(name);
+        s->size = sizeof(T);
+        write(i, *prop.ref());
+        header()->used.store(i + 1, std::memory_order_release);
+        prop.onValueChanged(m_context, [this, i](const T& value) { write(i, value); });
+        return static_cast<int>(i);
+    }
+
+private:
+    template <class T>
+    void write(uint32_t i, const T& value) {
+        SharedSlot* s = slot(i);
+        uint64_t seq = s->seq.load(std::memory_order_relaxed);
+        s->seq.store(seq + 1, std::memory_order_relaxed);
+        std::atomic_thread_fence(std::memory_order_release);
+        std::memcpy(payload(s), &value, sizeof(T));
+        s->seq.store(seq + 2, std::memory_order_release);
+        uint64_t epoch = header()->epoch.load(std::memory_order_relaxed) + 1;
+        epochs()[i].store(epoch, std::memory_order_release);
+        header()->epoch.store(epoch, std::memory_order_release);
+    }
+
+    BindingContext m_context; // disconnects the observers before the region is unmapped
+};
+
+// SharedStoreView maps a store read-only, from any process. Reads never block
+// the writer; a read that overlaps a write simply retries. A slot that stays
+// mid-write, as it does when the writer dies during a store, reads as nullopt.
+class SharedStoreView : public SharedStoreLayout {
+public:
+    // Times a read finds the slot mid-write before giving up on it.
+    static constexpr int ReadAttempts = 1024;
+
+    explicit SharedStoreView(const std::string& name) {
+        m_region = SharedRegion::open(name);
+        if(m_region && (m_region.size() < sizeof(SharedStoreHeader) || std::memcmp(header()->magic, Magic, sizeof(Magic)) != 0 ||
+                        header()->version != Version ||
+                        m_region.size() < regionSize(header()->slotCount, header()->slotSize)))
+            m_region = SharedRegion();
+    }
+
+    explicit operator bool() const { return static_cast<bool>(m_region); }
+
+    uint64_t epoch() const { return m_region ? header()->epoch.load(std::memory_order_acquire) : 0; }
+
+    // Slot index of a published name, -1 if it has not been published (yet).
+    int find(std::string_view name) const {
+        if(!m_region)
+            return -1;
+        uint64_t key = PropertySnapshot::key(name);
+        uint32_t used = header()->used.load(std::memory_order_acquire);
+        for(uint32_t i = 0; i < used; ++i) {
+            if(slot(i)->key == key)
+                return static_cast<int>(i);
+        }
+        return -1;
+    }
+
+    // 0 for a slot that has not been published.
+    uint64_t version(int i) const { return published(i) ? epochs()[i].load(std::memory_order_acquire) : 0; }
+
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    std::optional<T> read(int i) const {
+        if(!published(i))
+            return std::nullopt;
+        SharedSlot* s = slot(static_cast<size_t>(i));
+        if(s->size != sizeof(T))
+            return std::nullopt;
+        T value;
+        for(int attempt = 0; attempt < ReadAttempts; ++attempt) {
+            uint64_t before = s->seq.load(std::memory_order_acquire);
+            if(before & 1) {
+                std::this_thread::yield();
+                continue;
+            }
+            std::memcpy(&value, payload(s), sizeof(T));
+            std::atomic_thread_fence(std::memory_order_acquire);
+            if(s->seq.load(std::memory_order_relaxed) == before)
+                return value;
+        }
+        return std::nullopt;
+    }
+
+    template <class T>
+    std::optional<T> read(std::string_view name) const {
+        int i = find(name);
+        if(i < 0)
+            return std::nullopt;
+        return read<T>(i);
+    }
+
+    // Calls f(index) for every slot written after epoch.
+    template <std::invocable<int> F>
+    void forEachChanged(uint64_t epoch, F&& f) const {
+        if(!m_region)
+            return;
+        uint32_t used = header()->used.load(std::memory_order_acquire);
+        for(uint32_t i = 0; i < used; ++i) {
+            if(epochs()[i].load(std::memory_order_acquire) > epoch)
+                f(static_cast<int>(i));
+        }
+    }
+
+    // Keeps a local property in step with a published slot; call poll() from
+    // the reader's own loop to bring mirrors up to date.
+    template <class T>
+    requires std::is_trivially_copyable_v<T>
+    bool mirror(std::string_view name, property<T>& prop) {
+        int i = find(name);
+        if(i < 0 || slot(static_cast<size_t>(i))->size != sizeof(T))
+            return false;
+        auto update = [&prop](const SharedStoreView& view, int slot) {
+            if(auto value = view.read<T>(slot))
+                prop.setValue(*value);
+        };
+        update(*this, i);
+        m_mirrors.push_back({i, std::move(update)});
+        return true;
+    }
+
+    // Returns how many mirrors were refreshed.
+    size_t poll() {
+        uint64_t now = epoch();
+        if(now == m_seen)
+            return 0;
+        size_t n = 0;
+        PropertyBatch batch;
+        for(auto& m : m_mirrors) {
+            if(version(m.slot) > m_seen) {
+                m.update(*this, m.slot);
+                ++n;
+            }
+        }
+        m_seen = now;
+        return n;
+    }
+
+private:
+    bool published(int i) const {
+        return m_region && i >= 0 && static_cast<uint32_t>(i) < header()->used.load(std::memory_order_acquire);
+    }
+
+    struct Mirror {
+        int slot;
+        std::function<void(const SharedStoreView&, int)> update;
+    };
+
+    std::vector<Mirror> m_mirrors;
+    uint64_t m_seen = 0;
+};
+
+#endif
@@ -0,0 +1,197 @@
+#pragma once
+
+#include <cstring>
+#include <fstream>
+#include <string_view>
+#include <unordered_map>
+
+#include "Property.hpp"
+
+// SnapshotCodec turns a value into the bytes stored in a snapshot image.
+// Trivially copyable types are stored as-is; other types need a specialization.
+template <class T>
+struct SnapshotCodec {
+    static_assert(std::is_trivially_copyable_v<T>, "SnapshotCodec must be specialized for this type");
+
+    static void encode(const T& value, std::vector<std::byte>& out) {
+        auto bytes = std::as_bytes(std::span(&value, 1));
+        out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+
+    static bool decode(std::span<const std::byte> in, T& value) {
+        if(in.size() != sizeof(T))
+            return false;
+        std::memcpy(&value, in.data(), sizeof(T));
+        return true;
+    }
+};
+
+template <>
+struct SnapshotCodec<std::string> {
+    static void encode(const std::string& value, std::vector<std::byte>& out) {
+        auto bytes = std::as_bytes(std::span(value.data(), value.size()));
+        out.insert(out.end(), bytes.begin(), bytes.end());
+    }
+
+    static bool decode(std::span<const std::byte> in, std::string& value) {
+        value.assign(reinterpret_cast<const char*>(in.data()), in.size());
+        return true;
+    }
+};
+
+// Image layout, native byte order, each section 8-byte aligned so a mapped
+// image can be read in place:
+//   SnapshotHeader
+//   SnapshotEntry[count]
+//   payload, one 8-byte aligned blob per entry
+struct SnapshotHeader {
+    char magic[4];
+    uint32_t version;
+    uint32_t count;
+    uint32_t reserved;
+};
+
+struct SnapshotEntry {
+    uint64_t key;
+    uint32_t offset; // from the start of the image
+    uint32_t size;
+};
+
+static_assert(sizeof(SnapshotHeader) == 16 && sizeof(SnapshotEntry) == 16);
+
+// PropertySnapshot saves the source values of a registered set of properties
+// and restores them in one PropertyBatch, so the graph propagates once at the
+// end instead of once per restored property. Properties are matched by name,
+// entries for unknown names are ignored and bound properties are not saved.
+class PropertySnapshot {
+public:
+    static constexpr char Magic[4] = {'P', 'B', 'S', 'N'};
+    static constexpr uint32_t Version = 1;
+
+    // Fails if name has the key of a property added before, which would make
+    // the two indistinguishable in an image.
+    template <class T>
+    bool add(std::string_view name, property<T>& prop) {
+        uint64_t k = key(name);
+        if(m_index.contains(k))
+            return false;
+        Slot slot{
+            [&prop](std::vector<std::byte>& out) {
+                if(prop.isBound())
+                    return false;
+                SnapshotCodec<T>::encode(*prop.ref(), out);
+                return true;
+            },
+            [&prop](std::span<const std::byte> in) -> std::function<void()> {
+                T value{};
+                if(!SnapshotCodec<T>::decode(in, value))
+                    return {};
+                return [&prop, value = std::move(value)]() mutable { prop.setValue(std::move(value)); };
+            }};
+        m_index.emplace(k, m_slots.size());
+        m_slots.emplace_back(k, std::move(slot));
+        return true;
+    }
+
+    size_t size() const { return m_slots.size(); }
+
+    std::vector<std::byte> save() const {
+        std::vector<SnapshotEntry> entries;
+        std::vector<std::byte> payload;
+        entries.reserve(m_slots.size());
+        for(const auto& [k, slot] : m_slots) {
+            size_t begin = payload.size();
+            if(!slot.save(payload))
+                continue;
+            entries.push_back({k, static_cast<uint32_t>(begin), static_cast<uint32_t>(payload.size() - begin)});
+            payload.resize(align(payload.size()));
+        }
+
+        const size_t base = sizeof(SnapshotHeader) + entries.size() * sizeof(SnapshotEntry);
+        for(auto& e : entries)
+            e.offset += static_cast<uint32_t>(base);
+
+        SnapshotHeader header{};
+        std::memcpy(header.magic, Magic, sizeof(Magic));
+        header.version = Version;
+        header.count = static_cast<uint32_t>(entries.size());
+
+        std::vector<std::byte> image(base + payload.size());
+        std::memcpy(image.data(), &header, sizeof(header));
+        std::memcpy(image.data() + sizeof(header), entries.data(), entries.size() * sizeof(SnapshotEntry));
+        std::memcpy(image.data() + base, payload.data(), payload.size());
+        return image;
+    }
+
+    // Every entry is decoded before any property is touched, so a rejected
+    // image leaves all properties as they were.
+    bool restore(std::span<const std::byte> image) const {
+        SnapshotHeader header;
+        if(image.size() < sizeof(header))
+            return false;
+        std::memcpy(&header, image.data(), sizeof(header));
+        if(std::memcmp(header.magic, Magic, sizeof(Magic)) != 0 || header.version != Version)
+            return false;
+        if((image.size() - sizeof(header)) / sizeof(SnapshotEntry) < header.count)
+            return false;
+
+        std::vector<SnapshotEntry> entries(header.count);
+        std::memcpy(entries.data(), image.data() + sizeof(header), entries.size() * sizeof(SnapshotEntry));
+        std::vector<std::function<void()>> decoded;
+        decoded.reserve(entries.size());
+        for(const auto& e : entries) {
+            if(e.offset > image.size() || e.size > image.size() - e.offset)
+                return false;
+            auto it = m_index.find(e.key);
+            if(it == m_index.end())
+                continue;
+            decoded.push_back(m_slots[it->second].second.decode(image.subspan(e.offset, e.size)));
+            if(!decoded.back())
+                return false;
+        }
+
+        PropertyBatch batch;
+        for(auto& apply : decoded)
+            apply();
+        return true;
+    }
+
+    bool saveToFile(const std::string& path) const {
+        auto image = save();
+        std::ofstream file(path, std::ios::binary | std::ios::trunc);
+        file.write(reinterpret_cast<const char*>(image.data()), static_cast<std::streamsize>(image.size()));
+        return file.good();
+    }
+
+    bool restoreFromFile(const std::string& path) const {
+        std::ifstream file(path, std::ios::binary | std::ios::ate);
+        if(!file)
+            return false;
+        std::vector<std::byte> image(static_cast<size_t>(file.tellg()));
+        file.seekg(0);
+        file.read(reinterpret_cast<char*>(image.data()), static_cast<std::streamsize>(image.size()));
+        return file.good() && restore(image);
+    }
+
+    // 64-bit FNV-1a of the property name.
+    static constexpr uint64_t key(std::string_view name) {
+        uint64_t h = 0xcbf29ce484222325ull;
+        for(char c : name) {
+            h ^= static_cast<unsigned char>(c);
+            h *= 0x100000001b3ull;
+        }
+        return h;
+    }
+
+private:
+    static constexpr size_t align(size_t n) { return (n + 7) & ~size_t(7); }
+
+    struct Slot {
+        std::function<bool(std::vector<std::byte>&)> save;
+        // Returns what stores the decoded value, or nothing if the bytes are invalid.
+        std::function<std::function<void()>(std::span<const std::byte>)> decode;
+    };
+
+    std::vector<std::pair<uint64_t, Slot>> m_slots;
+    std::unordered_map<uint64_t, size_t> m_index;
+};
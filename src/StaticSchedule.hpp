@@ -0,0 +1,239 @@
+#pragma once
+
+#include <array>
+#include <tuple>
+
+#include "Property.hpp"
+
+// Static schedules are for plain structs whose fields depend on each other in a
+// fixed way. Each Rule computes one field from the fields it lists; the schedule
+// orders the rules at compile time and expands every update into straight-line
+// calls, with no notifier, link or wave involved:
+//
+//   struct Box { int x, width, right, center; };
+//   using BoxSchedule = StaticSchedule<Box,
+//       Rule<&Box::center, [](int x, int right) { return (x + right) / 2; }, &Box::x, &Box::right>,
+//       Rule<&Box::right, [](int x, int w) { return x + w; }, &Box::x, &Box::width>>;
+//
+// StaticObject holds such a struct and connects it to the dynamic engine, which
+// is then only involved for edges that leave or enter the object.
+
+namespace static_schedule_impl {
+
+// Member pointers of different types never name the same field.
+template <auto A, auto B>
+constexpr bool sameField() {
+    if constexpr(std::is_same_v<decltype(A), decltype(B)>)
+        return A == B;
+    else
+        return false;
+}
+
+} // namespace static_schedule_impl
+
+// Func is called with the listed input fields, in order, and its result is
+// assigned to Target.
+template <auto Target, auto Func, auto... Inputs>
+struct Rule {
+    static constexpr auto target = Target;
+
+    template <auto Field>
+    static constexpr bool reads = (static_schedule_impl::sameField<Field, Inputs>() || ...);
+
+    template <class S>
+    static void apply(S& s) { s.*Target = Func(s.*Inputs...); }
+};
+
+template <class S, class... Rules>
+class StaticSchedule {
+public:
+    using Struct = S;
+    static constexpr size_t size = sizeof...(Rules);
+
+private:
+    using Edges = std::array<std::array<bool, size>, size>;
+    using Mask = std::array<bool, size>;
+
+    template <class R>
+    static constexpr Mask readsTargetsOf() { return {R::template reads<Rules::target>...}; }
+
+    // edges[j][i]: rule j reads the field rule i writes.
+    static constexpr Edges edges = {readsTargetsOf<Rules>()...};
+
+    template <class>
+    static constexpr bool s_always = true;
+
+    template <class R, auto... Fields>
+    static constexpr bool readsAny() { return (R::template reads<Fields> || ...); }
+
+    template <class R>
+    static constexpr size_t writersOf() { return (static_schedule_impl::sameField<R::target, Rules::target>() + ...); }
+
+    struct Order {
+        std::array<size_t, size> rules{};
+        size_t count = 0;
+    };
+
+    static constexpr Order topological() {
+        Order order;
+        Mask done{};
+        bool progress = true;
+        while(progress && order.count < size) {
+            progress = false;
+            for(size_t j = 0; j < size; ++j) {
+                if(done[j])
+                    continue;
+                bool ready = true;
+                for(size_t i = 0; i < size; ++i)
+                    ready = ready && (!edges[j][i] || (done[i] && i != j));
+                if(ready) {
+                    done[j] = true;
+                    order.rules[order.count++] = j;
+                    progress = true;
+                }
+            }
+        }
+        return order;
+    }
+
+    static constexpr Order s_order = topological();
+    static_assert(s_order.count == size, "the rules of a static schedule form a cycle");
+    static_assert(((writersOf<Rules>() == 1) && ...), "two rules of a static schedule write the same field");
+
+public:
+    // Rule indices in evaluation order; every rule comes after the rules it reads.
+    static constexpr std::array<size_t, size> order = s_order.rules;
+
+    // The rules that have to run after Fields changed: those reading one of
+    // them, directly or through another rule.
+    template <auto... Fields>
+    static constexpr Mask downstream() {
+        constexpr Mask direct = {readsAny<Rules, Fields...>()...};
+        Mask affected{};
+        for(size_t j : order) {
+            affected[j] = direct[j];
+            for(size_t i = 0; i < size; ++i)
+                affected[j] = affected[j] || (edges[j][i] && affected[i]);
+        }
+        return affected;
+    }
+
+    // Runs every rule.
+    static void update(S& s) { run<Mask{s_always<Rules>...}>(s, std::make_index_sequence<size>()); }
+
+    // Runs only the rules downstream of Fields.
+    template <auto... Fields>
+    static void changed(S& s) { run<downstream<Fields...>()>(s, std::make_index_sequence<size>()); }
+
+private:
+    template <Mask M, size_t... I>
+    static void run(S& s, std::index_sequence<I...>) { (step<M[order[I]], order[I]>(s), ...); }
+
+    template <bool On, size_t R>
+    static void step(S& s) {
+        if constexpr(On)
+            std::tuple_element_t<R, std::tuple<Rules...>>::apply(s);
+    }
+};
+
+// StaticObject owns one struct of a static schedule. set() and modify() run
+// the affected rules and then notify once. Edges that cross object boundaries
+// go through the dynamic engine: bind() feeds a field from a property, and
+// output() exposes a field as a property that other bindings can use.
+template <class Schedule>
+class StaticObject {
+public:
+    using Struct = typename Schedule::Struct;
+
+    template <auto Field>
+    using FieldType = std::remove_cvref_t<decltype(std::declval<Struct&>().*Field)>;
+
+    explicit StaticObject(Struct value = {}) :
+        m_value(std::move(value)) { Schedule::update(m_value); }
+
+    StaticObject(const StaticObject&) = delete;
+    StaticObject& operator=(const StaticObject&) = delete;
+
+    const Struct& value() const {
+        DependencyTracker::record(&m_notifier);
+        return m_value;
+    }
+
+    template <auto Field>
+    const FieldType<Field>& get() const { return value().*Field; }
+
+    template <auto Field, std::convertible_to<FieldType<Field>> V>
+    void set(V&& v) {
+        m_value.*Field = std::forward<V>(v);
+        Schedule::template changed<Field>(m_value);
+        publish();
+    }
+
+    // f may write any of Fields; the rules downstream of them run once.
+    template <auto... Fields, std::invocable<Struct&> F>
+    void modify(F&& f) {
+        f(m_value);
+        Schedule::template changed<Fields...>(m_value);
+        publish();
+    }
+
+    // Keeps Field equal to source.
+    template <auto Field, class T, bool W>
+    void bind(const BasicProperty<T, W>& source) {
+        source.onValueChanged(m_context, [this, &source] { set<Field>(source.value()); });
+        set<Field>(source.value());
+    }
+
+    // A property following Field, created on first use.
+    template <auto Field>
+    const property<FieldType<Field>>& output() {
+        for(auto& o : m_outputs) {
+            if(o->key() == &s_key<Field>)
+                return static_cast<FieldOutput<Field>&>(*o).prop;
+        }
+        auto& o = m_outputs.emplace_back(std::make_unique<FieldOutput<Field>>(m_value.*Field));
+        return static_cast<FieldOutput<Field>&>(*o).prop;
+    }
+
+    template <std::invocable F>
+    void onValueChanged(F&& f) const {
+        m_notifier.addObserver(std::forward<F>(f));
+    }
+
+private:
+    struct Output {
+        virtual ~Output() = default;
+        virtual const void* key() const = 0;
+        virtual void refresh(const Struct& s) = 0;
+    };
+
+    template <auto Field>
+    struct FieldOutput : Output {
+        explicit FieldOutput(const FieldType<Field>& v) :
+            prop(v) { }
+
+        const void* key() const override { return &s_key<Field>; }
+        void refresh(const Struct& s) override { prop = s.*Field; }
+
+        property<FieldType<Field>> prop;
+    };
+
+    template <auto Field>
+    static constexpr char s_key = 0;
+
+    void publish() {
+        if(m_outputs.empty()) {
+            m_notifier.notify();
+            return;
+        }
+        PropertyBatch batch;
+        for(auto& o : m_outputs)
+            o->refresh(m_value);
+        m_notifier.notify();
+    }
+
+    Struct m_value;
+    mutable BindingNotifier m_notifier;
+    std::vector<std::unique_ptr<Output>> m_outputs;
+    BindingContext m_context;
+};
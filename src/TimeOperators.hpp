@@ -0,0 +1,235 @@
+#pragma once
+
+#include <map>
+#include <optional>
+#include <unordered_map>
+
+#include "Property.hpp"
+
+// PropertyClock is the time source and timer queue behind the time-based
+// operators. Timers run from poll(), so they fire on the thread that drives
+// the clock (frame loop, event loop or a test), never asynchronously.
+class PropertyClock {
+public:
+    using duration = std::chrono::steady_clock::duration;
+    using time_point = std::chrono::steady_clock::time_point;
+    using TimerId = uint64_t;
+
+    virtual ~PropertyClock() = default;
+    virtual time_point now() const = 0;
+
+    TimerId schedule(time_point at, std::function<void()> func) {
+        TimerId id = m_nextId++;
+        m_index.emplace(id, m_timers.emplace(at, Timer{id, std::move(func)}));
+        return id;
+    }
+
+    void cancel(TimerId id) {
+        if(auto it = m_index.find(id); it != m_index.end()) {
+            m_timers.erase(it->second);
+            m_index.erase(it);
+        }
+    }
+
+    std::optional<time_point> nextDeadline() const {
+        if(m_timers.empty())
+            return std::nullopt;
+        return m_timers.begin()->first;
+    }
+
+    // Runs every timer that is due, including timers scheduled by them.
+    size_t poll() {
+        size_t n = 0;
+        time_point t = now();
+        while(!m_timers.empty() && m_timers.begin()->first <= t) {
+            runFirst();
+            ++n;
+        }
+        return n;
+    }
+
+protected:
+    void runFirst() {
+        auto node = m_timers.extract(m_timers.begin());
+        m_index.erase(node.mapped().id);
+        node.mapped().func();
+    }
+
+private:
+    struct Timer {
+        TimerId id;
+        std::function<void()> func;
+    };
+
+    std::multimap<time_point, Timer> m_timers;
+    std::unordered_map<TimerId, std::multimap<time_point, Timer>::iterator> m_index;
+    TimerId m_nextId = 1;
+};
+
+class SteadyPropertyClock : public PropertyClock {
+public:
+    time_point now() const override { return std::chrono::steady_clock::now(); }
+};
+
+// Time only moves when advance() is called; timers fire at their own deadline
+// as time passes over them, so tests are exact and independent of real time.
+class ManualClock : public PropertyClock {
+public:
+    time_point now() const override { return m_now; }
+
+    void advance(duration d) {
+        time_point target = m_now + d;
+        while(auto next = nextDeadline()) {
+            if(*next > target)
+                break;
+            m_now = std::max(m_now, *next);
+            runFirst();
+        }
+        m_now = target;
+    }
+
+private:
+    time_point m_now{};
+};
+
+// ---------- operators -------------
+// Each operator reads its source through an alias property it owns, so the
+// source may die first, and writes the reduced-rate result to output(), which
+// can be observed or bound like any other property.
+
+template <class T>
+class TimedOperator {
+public:
+    TimedOperator(const TimedOperator&) = delete;
+    TimedOperator& operator=(const TimedOperator&) = delete;
+
+    ~TimedOperator() {
+        if(m_timer)
+            m_clock.cancel(m_timer);
+    }
+
+    const property<T>& output() const { return m_output; }
+    T value() const { return m_output.value(); }
+
+protected:
+    template <bool W>
+    TimedOperator(const BasicProperty<T, W>& source, PropertyClock& clock) :
+        m_input(const_cast<BasicProperty<T, W>&>(source)), m_output(*m_input.ref()), m_clock(clock) { }
+
+    void emit() { m_output = *m_input.ref(); }
+
+    void start(PropertyClock::time_point at, std::function<void()> func) {
+        m_timer = m_clock.schedule(at, [this, func = std::move(func)] {
+            m_timer = 0;
+            func();
+        });
+    }
+
+    void stop() {
+        if(m_timer) {
+            m_clock.cancel(m_timer);
+            m_timer = 0;
+        }
+    }
+
+    property<T> m_input;
+    property<T> m_output;
+    PropertyClock& m_clock;
+    PropertyClock::TimerId m_timer = 0;
+};
+
+// Emits the latest value once the source has been quiet for `delay`.
+template <class T>
+class Debounced : public TimedOperator<T> {
+    using Base = TimedOperator<T>;
+
+public:
+    template <bool W>
+    Debounced(const BasicProperty<T, W>& source, PropertyClock::duration delay, PropertyClock& clock) :
+        Base(source, clock), m_delay(delay) {
+        this->m_input.onValueChanged([this] {
+            this->stop();
+            this->start(this->m_clock.now() + m_delay, [this] { this->emit(); });
+        });
+    }
+
+private:
+    PropertyClock::duration m_delay;
+};
+
+// Emits at most once per `interval`: the first change immediately, later ones
+// coalesced into a trailing emission at the end of the interval.
+template <class T>
+class Throttled : public TimedOperator<T> {
+    using Base = TimedOperator<T>;
+
+public:
+    template <bool W>
+    Throttled(const BasicProperty<T, W>& source, PropertyClock::duration interval, PropertyClock& clock) :
+        Base(source, clock), m_interval(interval) {
+        this->m_input.onValueChanged([this] { onChanged(); });
+    }
+
+private:
+    void onChanged() {
+        if(this->m_timer)
+            return;
+        auto now = this->m_clock.now();
+        if(!m_last || now - *m_last >= m_interval) {
+            fire(now);
+        } else {
+            this->start(*m_last + m_interval, [this] { fire(this->m_clock.now()); });
+        }
+    }
+
+    void fire(PropertyClock::time_point now) {
+        m_last = now;
+        this->emit();
+    }
+
+    PropertyClock::duration m_interval;
+    std::optional<PropertyClock::time_point> m_last;
+};
+
+// Emits every `period` if the source changed since the previous sample.
+template <class T>
+class Sampled : public TimedOperator<T> {
+    using Base = TimedOperator<T>;
+
+public:
+    template <bool W>
+    Sampled(const BasicProperty<T, W>& source, PropertyClock::duration period, PropertyClock& clock) :
+        Base(source, clock), m_period(period) {
+        this->m_input.onValueChanged([this] { m_dirty = true; });
+        tick(this->m_clock.now() + m_period);
+    }
+
+private:
+    void tick(PropertyClock::time_point at) {
+        this->start(at, [this, at] {
+            if(m_dirty) {
+                m_dirty = false;
+                this->emit();
+            }
+            tick(at + m_period);
+        });
+    }
+
+    PropertyClock::duration m_period;
+    bool m_dirty = false;
+};
+
+template <class T, bool W>
+inline Debounced<T> debounce(const BasicProperty<T, W>& source, PropertyClock::duration delay, PropertyClock& clock) {
+    return Debounced<T>(source, delay, clock);
+}
+
+template <class T, bool W>
+inline Throttled<T> throttle(const BasicProperty<T, W>& source, PropertyClock::duration interval, PropertyClock& clock) {
+    return Throttled<T>(source, interval, clock);
+}
+
+template <class T, bool W>
+inline Sampled<T> sample(const BasicProperty<T, W>& source, PropertyClock::duration period, PropertyClock& clock) {
+    return Sampled<T>(source, period, clock);
+}
@@ -0,0 +1,170 @@
+#pragma once
+
+#include <memory>
+#include <random>
+#include <string>
+#include <vector>
+
+#include "../src/Property.hpp"
+
+enum class Shape {
+    Chain,   // node i = node i-1 + k
+    Fanout,  // node i = node 0 + k
+    Random,  // node i = one or two random earlier nodes
+    Layered  // node i = two nodes of the previous layer
+};
+
+// A graph of property<int> nodes together with a plain reference model of what
+// every node should evaluate to. Each expression the engine holds is a ref over
+// other refs; rebinding rewrites a node's ref in place, so the model is evaluated
+// in dependency order rather than ref order.
+// Reads are not memoized by the engine and cost one evaluation per path to the
+// sources: keep layered graphs shallow. Values stay far below int range: xor
+// never widens and each +k adds at most 16.
+class StressGraph {
+public:
+    StressGraph(Shape shape, size_t nodes, size_t width, uint64_t seed) :
+        m_shape(shape), m_width(std::max<size_t>(width, 1)), m_rng(seed) {
+        m_props.reserve(nodes);
+        m_slots.reserve(nodes);
+        for(size_t i = 0; i < nodes; ++i) {
+            m_props.push_back(std::make_unique<property<int>>(0));
+            m_slots.push_back(newRef());
+            if(!bindInitial(i))
+                write(i);
+        }
+    }
+
+    size_t size() const { return m_props.size(); }
+
+    property<int>& node(size_t i) { return *m_props[i]; }
+
+    // Turns node i into a source with a random value.
+    void write(size_t i) {
+        int v = static_cast<int>(m_rng() % 1024);
+        m_props[i]->setValue(v);
+        m_refs[m_slots[i]] = {Ref::Source, v, 0, 0};
+    }
+
+    // Rebinds node i to a random expression over lower nodes. Dependents stay
+    // attached and follow the new expression, so the node keeps its ref.
+    bool rebind(size_t i) {
+        if(i == 0)
+            return false;
+        size_t a = m_rng() % i;
+        if(m_rng() % 2)
+            return bindAdd(i, a, static_cast<int>(m_rng() % 33) - 16);
+        return bindXor(i, a, m_rng() % i);
+    }
+
+    // Destroys node i and puts a fresh source in its place. Dependents keep the
+    // value the old node had, which is what ~BasicProperty freezes for them.
+    // Call evaluate() first; it is left out so it does not count as the cost
+    // of the destroy.
+    void destroy(size_t i) {
+        m_refs[m_slots[i]] = {Ref::Source, m_values[m_slots[i]], 0, 0};
+        m_props[i].reset();
+        m_props[i] = std::make_unique<property<int>>(0);
+        m_slots[i] = newRef();
+        write(i);
+    }
+
+    int expected(size_t i) const { return m_values[m_slots[i]]; }
+
+    // Destroys every node, sources first.
+    void clear() { m_props.clear(); }
+
+    // Brings expected() up to date; O(refs). Inputs are evaluated first with
+    // an explicit stack, chains can be as long as the graph.
+    void evaluate() {
+        m_values.resize(m_refs.size());
+        m_done.assign(m_refs.size(), false);
+        for(uint32_t root = 0; root < m_refs.size(); ++root) {
+            if(m_done[root])
+                continue;
+            m_stack.push_back(root);
+            while(!m_stack.empty()) {
+                uint32_t r = m_stack.back();
+                if(m_done[r]) {
+                    m_stack.pop_back();
+                    continue;
+                }
+                const Ref& ref = m_refs[r];
+                bool ready = true;
+                if(ref.kind != Ref::Source) {
+                    for(uint32_t in : {ref.b, ref.kind == Ref::Xor ? ref.c : ref.b}) {
+                        if(!m_done[in]) {
+                            m_stack.push_back(in);
+                            ready = false;
+                        }
+                    }
+                }
+                if(!ready)
+                    continue;
+                m_stack.pop_back();
+                switch(ref.kind) {
+                case Ref::Source: m_values[r] = ref.a; break;
+                case Ref::Add: m_values[r] = m_values[ref.b] + ref.a; break;
+                case Ref::Xor: m_values[r] = m_values[ref.b] ^ m_values[ref.c]; break;
+                }
+                m_done[r] = true;
+            }
+        }
+    }
+
+    std::mt19937_64& rng() { return m_rng; }
+
+private:
+    // Source: a = value. Add: b + a. Xor: b ^ c. b and c are ref indices.
+    struct Ref {
+        enum Kind : uint8_t { Source, Add, Xor } kind;
+        int a;
+        uint32_t b;
+        uint32_t c;
+    };
+
+    uint32_t newRef() {
+        m_refs.push_back({Ref::Source, 0, 0, 0});
+        return static_cast<uint32_t>(m_refs.size() - 1);
+    }
+
+    bool bindInitial(size_t i) {
+        if(i == 0)
+            return false;
+        int k = static_cast<int>(m_rng() % 33) - 16;
+        switch(m_shape) {
+        case Shape::Chain: return bindAdd(i, i - 1, k);
+        case Shape::Fanout: return bindAdd(i, 0, k);
+        case Shape::Random: return rebind(i);
+        case Shape::Layered: {
+            if(i < m_width)
+                return false;
+            size_t layer = i / m_width * m_width - m_width;
+            return bindXor(i, layer + m_rng() % m_width, layer + m_rng() % m_width);
+        }
+        }
+        return false;
+    }
+
+    bool bindAdd(size_t i, size_t a, int k) {
+        *m_props[i] = *m_props[a] + k;
+        m_refs[m_slots[i]] = {Ref::Add, k, m_slots[a], 0};
+        return true;
+    }
+
+    bool bindXor(size_t i, size_t a, size_t b) {
+        *m_props[i] = *m_props[a] ^ *m_props[b];
+        m_refs[m_slots[i]] = {Ref::Xor, 0, m_slots[a], m_slots[b]};
+        return true;
+    }
+
+    Shape m_shape;
+    size_t m_width;
+    std::mt19937_64 m_rng;
+    std::vector<std::unique_ptr<property<int>>> m_props;
+    std::vector<uint32_t> m_slots; // node -> current ref
+    std::vector<Ref> m_refs;
+    std::vector<int> m_values;
+    std::vector<bool> m_done;
+    std::vector<uint32_t> m_stack;
+};
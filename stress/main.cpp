@@ -0,0 +1,216 @@
+#include <atomic>
+#include <charconv>
+#include <cstdio>
+#include <cstdlib>
+#include <cstring>
+#include <new>
+
+#if defined(__linux__)
+#include <sys/resource.h>
+#endif
+
+#include "Graph.hpp"
+
+// Every allocation made by the process is counted, so the report can show
+// what building the graph and each workload cost in heap traffic.
+static std::atomic<uint64_t> s_allocations = 0;
+
+void* operator new(size_t size) {
+    s_allocations.fetch_add(1, std::memory_order_relaxed);
+    if(void* p = std::malloc(size ? size : 1))
+        return p;
+    throw std::bad_alloc();
+}
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+
+namespace {
+
+struct Options {
+    Shape shape = Shape::Random;
+    size_t nodes = 100000;
+    size_t width = 1000;
+    size_t ops = 1000000;
+    uint64_t seed = 1;
+    size_t checkEvery = 100000;
+    size_t samples = 100;
+    double observed = 0.01; // fraction of nodes with an observer
+    unsigned mix[4] = {60, 30, 8, 2}; // write, read, rebind, destroy
+};
+
+enum Op { Write, Read, Rebind, Destroy, OpCount };
+const char* const OpNames[OpCount] = {"write", "read", "rebind", "destroy"};
+
+struct OpStats {
+    uint64_t count = 0;
+    uint64_t ns = 0;
+    uint64_t allocations = 0;
+};
+
+uint64_t now() { return PropertyTracer::now(); }
+
+long peakRssKb() {
+#if defined(__linux__)
+    rusage usage{};
+    getrusage(RUSAGE_SELF, &usage);
+    return usage.ru_maxrss;
+#else
+    return -1;
+#endif
+}
+
+template <class T>
+bool parseNumber(const char* s, T& out) {
+    auto end = s + std::strlen(s);
+    return std::from_chars(s, end, out).ptr == end;
+}
+
+bool parse(int argc, char** argv, Options& o) {
+    for(int i = 1; i < argc; ++i) {
+        const char* arg = argv[i];
+        const char* value = i + 1 < argc ? argv[i + 1] : nullptr;
+        if(!value)
+            return false;
+        ++i;
+        bool ok = true;
+        if(!std::strcmp(arg, "--shape")) {
+            if(!std::strcmp(value, "chain"))
+                o.shape = Shape::Chain;
+            else if(!std::strcmp(value, "fanout"))
+                o.shape = Shape::Fanout;
+            else if(!std::strcmp(value, "random"))
+                o.shape = Shape::Random;
+            else if(!std::strcmp(value, "layered"))
+                o.shape = Shape::Layered;
+            else
+                ok = false;
+        } else if(!std::strcmp(arg, "--nodes")) {
+            ok = parseNumber(value, o.nodes) && o.nodes > 0;
+        } else if(!std::strcmp(arg, "--width")) {
+            ok = parseNumber(value, o.width);
+        } else if(!std::strcmp(arg, "--ops")) {
+            ok = parseNumber(value, o.ops);
+        } else if(!std::strcmp(arg, "--seed")) {
+            ok = parseNumber(value, o.seed);
+        } else if(!std::strcmp(arg, "--check-every")) {
+            ok = parseNumber(value, o.checkEvery);
+        } else if(!std::strcmp(arg, "--samples")) {
+            ok = parseNumber(value, o.samples);
+        } else if(!std::strcmp(arg, "--observed")) {
+            o.observed = std::atof(value);
+        } else if(!std::strcmp(arg, "--mix")) {
+            ok = std::sscanf(value, "%u,%u,%u,%u", &o.mix[0], &o.mix[1], &o.mix[2], &o.mix[3]) == 4 &&
+                 o.mix[0] + o.mix[1] + o.mix[2] + o.mix[3] > 0;
+        } else {
+            ok = false;
+        }
+        if(!ok)
+            return false;
+    }
+    return true;
+}
+
+// Compares a sample of nodes (all of them if samples >= nodes) with the model.
+size_t validate(StressGraph& graph, size_t samples) {
+    graph.evaluate();
+    size_t mismatches = 0;
+    auto check = [&](size_t i) {
+        int got = graph.node(i).value();
+        if(got != graph.expected(i)) {
+            if(mismatches < 10)
+                std::fprintf(stderr, "mismatch at node %zu: got %d, expected %d\n", i, got, graph.expected(i));
+            ++mismatches;
+        }
+    };
+    if(samples >= graph.size()) {
+        for(size_t i = 0; i < graph.size(); ++i)
+            check(i);
+    } else {
+        for(size_t k = 0; k < samples; ++k)
+            check(graph.rng()() % graph.size());
+    }
+    return mismatches;
+}
+
+} // namespace
+
+int main(int argc, char** argv) {
+    Options o;
+    if(!parse(argc, argv, o)) {
+        std::fprintf(stderr,
+                     "usage: %s [--shape chain|fanout|random|layered] [--nodes N] [--width W] [--ops N] [--seed S]\n"
+                     "          [--check-every N] [--samples K] [--observed F] [--mix write,read,rebind,destroy]\n",
+                     argv[0]);
+        return 2;
+    }
+    uint64_t allocations = s_allocations.load();
+    uint64_t begin = now();
+    StressGraph graph(o.shape, o.nodes, o.width, o.seed);
+    uint64_t observers = 0;
+    for(size_t i = 0; i < graph.size(); ++i) {
+        if(std::generate_canonical<double, 32>(graph.rng()) < o.observed)
+            graph.node(i).onValueChanged([&observers] { ++observers; });
+    }
+    uint64_t buildNs = now() - begin;
+    uint64_t buildAllocations = s_allocations.load() - allocations;
+
+    OpStats stats[OpCount];
+    unsigned total = o.mix[0] + o.mix[1] + o.mix[2] + o.mix[3];
+    size_t mismatches = validate(graph, o.samples);
+    volatile int sink = 0;
+    uint64_t workBegin = now();
+    for(size_t n = 0; n < o.ops; ++n) {
+        unsigned pick = static_cast<unsigned>(graph.rng()() % total);
+        int op = 0;
+        while(pick >= o.mix[op])
+            pick -= o.mix[op++];
+        size_t i = graph.rng()() % graph.size();
+
+        if(op == Destroy)
+            graph.evaluate();
+        uint64_t a = s_allocations.load(std::memory_order_relaxed);
+        uint64_t t = now();
+        switch(op) {
+        case Write: graph.write(i); break;
+        case Read: sink = graph.node(i).value(); break;
+        case Rebind: graph.rebind(i); break;
+        case Destroy: graph.destroy(i); break;
+        }
+        stats[op].ns += now() - t;
+        stats[op].allocations += s_allocations.load(std::memory_order_relaxed) - a;
+        ++stats[op].count;
+
+        if(o.checkEvery && (n + 1) % o.checkEvery == 0)
+            mismatches += validate(graph, o.samples);
+    }
+    uint64_t workNs = now() - workBegin;
+    mismatches += validate(graph, o.samples);
+    (void)sink;
+
+    size_t nodes = graph.size(); // the graph is empty after teardown
+    uint64_t teardownBegin = now();
+    {
+        PropertyTeardown teardown;
+        graph.clear();
+    }
+    uint64_t teardownNs = now() - teardownBegin;
+
+    std::printf("nodes %zu, build %.1f ms, %.1f allocations/node\n", nodes, buildNs / 1e6,
+                static_cast<double>(buildAllocations) / static_cast<double>(nodes));
+    std::printf("ops %zu in %.1f ms, %.0f ops/s, %llu observer calls\n", o.ops, workNs / 1e6,
+                workNs ? static_cast<double>(o.ops) * 1e9 / static_cast<double>(workNs) : 0.0,
+                static_cast<unsigned long long>(observers));
+    for(int op = 0; op < OpCount; ++op) {
+        const OpStats& s = stats[op];
+        if(!s.count)
+            continue;
+        std::printf("  %-8s %10llu  %10.0f ns/op  %6.2f allocations/op\n", OpNames[op], static_cast<unsigned long long>(s.count),
+                    static_cast<double>(s.ns) / static_cast<double>(s.count),
+                    static_cast<double>(s.allocations) / static_cast<double>(s.count));
+    }
+    std::printf("teardown %.1f ms\n", teardownNs / 1e6);
+    std::printf("peak rss %ld kB\n", peakRssKb());
+    std::printf("mismatches %zu\n", mismatches);
+    return mismatches ? 1 : 0;
+}
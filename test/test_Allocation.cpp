@@ -0,0 +1,177 @@
+#include "gtest/gtest.h"
+#include <cstddef>
+#include <cstdlib>
+#include <new>
+#include "../src/Property.hpp"
+
+// Counts the heap allocations made by the current thread, so a test can assert
+// that an operation does not allocate once the graph is built.
+namespace {
+thread_local uint64_t t_allocations = 0;
+
+template <class F>
+uint64_t allocationsOf(F&& f) {
+    uint64_t before = t_allocations;
+    f();
+    return t_allocations - before;
+}
+} // namespace
+
+// Every form of new and delete is replaced, so memory taken by one form is
+// never released by the toolchain's own counterpart of another (nothrow new
+// is used by std::get_temporary_buffer, aligned new by over-aligned types).
+namespace {
+void* allocate(size_t size, size_t align = 0) noexcept {
+    ++t_allocations;
+    size = size ? size : 1;
+    if(align <= alignof(std::max_align_t))
+        return std::malloc(size);
+    return std::aligned_alloc(align, (size + align - 1) / align * align);
+}
+
+void* allocateOrThrow(size_t size, size_t align = 0) {
+    if(void* p = allocate(size, align))
+        return p;
+    throw std::bad_alloc();
+}
+} // namespace
+
+void* operator new(size_t size) { return allocateOrThrow(size); }
+void* operator new[](size_t size) { return allocateOrThrow(size); }
+void* operator new(size_t size, std::align_val_t a) { return allocateOrThrow(size, size_t(a)); }
+void* operator new[](size_t size, std::align_val_t a) { return allocateOrThrow(size, size_t(a)); }
+void* operator new(size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new[](size_t size, const std::nothrow_t&) noexcept { return allocate(size); }
+void* operator new(size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return allocate(size, size_t(a)); }
+void* operator new[](size_t size, std::align_val_t a, const std::nothrow_t&) noexcept { return allocate(size, size_t(a)); }
+
+void operator delete(void* p) noexcept { std::free(p); }
+void operator delete[](void* p) noexcept { std::free(p); }
+void operator delete(void* p, size_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete[](void* p, size_t, std::align_val_t) noexcept { std::free(p); }
+void operator delete(void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete(void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+void operator delete[](void* p, std::align_val_t, const std::nothrow_t&) noexcept { std::free(p); }
+
+TEST(Allocation, steadyStateWrites) {
+    property<int> a = 1;
+    property<int> b = 2;
+    property<int> left = a + b;
+    property<int> right = a * 2;
+    property<int> joined = left + right;
+    property<double> scaled = 0.0;
+    property<std::string> name = std::string("item");
+    int seen = 0, seenValue = 0;
+    joined.onValueChanged([&seen] { ++seen; });
+    joined.onValueChanged([&seenValue](const int& v) { seenValue = v; });
+    Connection c = a.connect([] {});
+
+    // the first write of each source creates its notifier handle
+    a = 0;
+    b = 0;
+    scaled = 0.5;
+    name = std::string("abcd");
+    EXPECT_EQ(allocationsOf([&] {
+        for(int i = 1; i <= 100; ++i) {
+            a = i;
+            b.setValue(i * 3);
+            scaled = i * 0.5;
+            name = i % 2 ? "odd" : "even";
+        }
+    }), 0u);
+    EXPECT_EQ(joined.value(), 100 + 300 + 200);
+    EXPECT_EQ(seenValue, 600);
+    EXPECT_EQ(seen, 202);
+
+    int sum = 0;
+    EXPECT_EQ(allocationsOf([&] {
+        for(int i = 0; i < 100; ++i)
+            sum += joined.value() + *left.ref();
+    }), 0u);
+    EXPECT_GT(sum, 0);
+}
+
+TEST(Allocation, steadyStateBatches) {
+    property<int> x = 0;
+    property<int> y = 0;
+    property<int> sum = x + y;
+    int fired = 0;
+    sum.onValueChanged([&fired] { ++fired; });
+    for(int i = 0; i < 2; ++i) {
+        PropertyBatch batch; // warms the pending and spare queues
+        x = 1 - i;
+        y = 1 - i;
+    }
+    EXPECT_EQ(allocationsOf([&] {
+        for(int i = 2; i < 50; ++i) {
+            PropertyBatch batch;
+            x = i;
+            y = i;
+        }
+    }), 0u);
+    EXPECT_EQ(fired, 50);
+
+    NotifyScheduler scheduler;
+    EXPECT_EQ(allocationsOf([&] {
+        for(int i = 1; i < 50; ++i) {
+            x = i;
+            y = -i;
+            scheduler.flush();
+        }
+    }), 0u);
+    EXPECT_EQ(sum.value(), 0);
+}
+
+TEST(Allocation, boundPropertyTurnsIntoSource) {
+    property<int> a = 1;
+    property<int> b = a + 1;
+    property<int> c = b * 10;
+    b = 5; // replaces the binding with a stored value once
+    EXPECT_EQ(c.value(), 50);
+    EXPECT_EQ(allocationsOf([&] {
+        for(int i = 0; i < 10; ++i)
+            b = i;
+    }), 0u);
+    EXPECT_EQ(c.value(), 90);
+}
+
+TEST(Allocation, rebindInPlace) {
+    property<int> a = 1;
+    property<int> b = 2;
+    property<int> mode = a + b;
+    property<int> label = mode * 10;
+    label.onValueChanged([] {});
+    mode = a - b;
+    // the binding's notifier list takes two allocations, the rebind itself
+    // only the new evaluation functor
+    uint64_t n = allocationsOf([&] {
+        for(int i = 0; i < 5; ++i) {
+            mode = a + b;
+            mode = a - b;
+        }
+    });
+    EXPECT_EQ(n, 10u * 3);
+    EXPECT_EQ(label.value(), -10);
+}
+
+TEST(Allocation, computedRetracking) {
+    property<int> a = 1;
+    property<int> b = 2;
+    property<int> larger = computed([&] { return std::max(a.value(), b.value()); });
+    int seen = 0;
+    larger.onValueChanged([&seen](const int& v) { seen = v; });
+    a = 0;
+    b = 0;
+    EXPECT_EQ(allocationsOf([&] {
+        for(int i = 1; i <= 100; ++i) {
+            a = i;
+            b = 200 - i;
+        }
+    }), 0u);
+    EXPECT_EQ(seen, 100);
+}
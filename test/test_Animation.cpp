@@ -0,0 +1,115 @@
+#include "gtest/gtest.h"
+#include "../src/Animation.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(Animation, easing) {
+    for(auto curve : {Easing::Linear, Easing::InQuad, Easing::OutQuad, Easing::InOutQuad, Easing::InCubic, Easing::OutCubic,
+                      Easing::InOutCubic}) {
+        EXPECT_DOUBLE_EQ(ease(curve, 0.0), 0.0);
+        EXPECT_DOUBLE_EQ(ease(curve, 1.0), 1.0);
+    }
+    EXPECT_DOUBLE_EQ(ease(Easing::InOutQuad, 0.5), 0.5);
+    EXPECT_LT(ease(Easing::InQuad, 0.25), 0.25);
+    EXPECT_GT(ease(Easing::OutCubic, 0.25), 0.25);
+}
+
+TEST(Animation, batchedTick) {
+    ManualClock clock;
+    Animator animator(clock);
+    property<int> x = 0;
+    property<double> width = 10;
+    property<double> right = x + width;
+    int fired = 0;
+    right.onValueChanged([&fired] { ++fired; });
+
+    animator.animate(x, 100, 100ms);
+    animator.animate(width, 20.0, 200ms, Easing::InQuad);
+    EXPECT_EQ(animator.active(), 2u);
+
+    clock.advance(50ms);
+    animator.tick();
+    EXPECT_EQ(x.value(), 50);
+    EXPECT_DOUBLE_EQ(width.value(), 10 + 10 * 0.25 * 0.25);
+    EXPECT_EQ(fired, 1);
+
+    clock.advance(50ms);
+    animator.tick();
+    EXPECT_EQ(x.value(), 100);
+    EXPECT_FALSE(animator.isAnimating(x));
+    EXPECT_TRUE(animator.isAnimating(width));
+    EXPECT_EQ(fired, 2);
+
+    clock.advance(500ms);
+    animator.tick();
+    EXPECT_DOUBLE_EQ(width.value(), 20);
+    EXPECT_DOUBLE_EQ(right.value(), 120);
+    EXPECT_EQ(animator.active(), 0u);
+}
+
+TEST(Animation, restartAndStop) {
+    ManualClock clock;
+    Animator animator(clock);
+    property<float> opacity = 0;
+    property<int> y = 0;
+
+    animator.animate(opacity, 1.0f, 100ms);
+    animator.animate(y, 0, 40, 100ms);
+    clock.advance(50ms);
+    animator.tick();
+    EXPECT_FLOAT_EQ(opacity.value(), 0.5f);
+
+    // retarget from the current value, the clock restarts
+    animator.animate(opacity, 0.0f, 100ms);
+    EXPECT_EQ(animator.active(), 2u);
+    EXPECT_TRUE(animator.stop(y));
+    EXPECT_FALSE(animator.stop(y));
+    clock.advance(50ms);
+    animator.tick();
+    EXPECT_FLOAT_EQ(opacity.value(), 0.25f);
+    EXPECT_EQ(y.value(), 20);
+
+    animator.animate(y, 7, 0ms);
+    EXPECT_EQ(y.value(), 7);
+    EXPECT_FALSE(animator.isAnimating(y));
+}
+
+TEST(Animation, observersChangeAnimationsDuringTick) {
+    ManualClock clock;
+    Animator animator(clock);
+    property<int> x = 0;
+    property<int> y = 0;
+    property<int> z = 0;
+    animator.animate(z, 10, 200ms);
+    animator.animate(y, 10, 100ms);
+    animator.animate(x, 10, 100ms);
+
+    // x stops y when it finishes; z restarts towards 0 when it reaches 10
+    x.onValueChanged([&](const int& v) {
+        if(v == 10)
+            animator.stop(y);
+    });
+    z.onValueChanged([&](const int& v) {
+        if(v == 10)
+            animator.animate(z, 0, 100ms);
+    });
+
+    clock.advance(100ms);
+    animator.tick();
+    EXPECT_EQ(x.value(), 10);
+    EXPECT_FALSE(animator.isAnimating(x));
+    EXPECT_FALSE(animator.isAnimating(y));
+    EXPECT_TRUE(animator.isAnimating(z));
+    EXPECT_EQ(animator.active(), 1u);
+
+    clock.advance(100ms);
+    animator.tick();
+    EXPECT_EQ(z.value(), 10);
+    EXPECT_TRUE(animator.isAnimating(z));
+    EXPECT_EQ(animator.active(), 1u);
+
+    clock.advance(150ms);
+    animator.tick();
+    EXPECT_EQ(z.value(), 0);
+    EXPECT_FALSE(animator.isAnimating(z));
+}
@@ -0,0 +1,74 @@
+#include "gtest/gtest.h"
+#include "../src/ChangePoller.hpp"
+
+TEST(ChangePoller, versions) {
+    property<int> a = 1;
+    property<int> b = 2;
+    property<int> sum = a + b;
+    list_property<int> rows = {1, 2};
+
+    ChangePoller poller;
+    size_t ia = poller.add(a);
+    size_t ib = poller.add(b);
+    size_t isum = poller.add(sum);
+    size_t irows = poller.add(rows);
+
+    uint64_t seen = ChangeEpoch::current();
+    EXPECT_FALSE(poller.changedSince(seen));
+
+    a = 5;
+    EXPECT_EQ(poller.changedSinceList(seen), (std::vector<size_t>{ia, isum}));
+    EXPECT_GT(sum.version(), seen);
+    EXPECT_EQ(b.version(), 0u);
+
+    seen = ChangeEpoch::current();
+    a = 5; // same value, not a change
+    EXPECT_FALSE(poller.changedSince(seen));
+
+    rows.push_back(3);
+    b = 7;
+    EXPECT_EQ(poller.changedSinceList(seen), (std::vector<size_t>{ib, isum, irows}));
+    EXPECT_EQ(sum.value(), 12);
+}
+
+TEST(ChangePoller, plainVersions) {
+    auto before = PropertyMetrics::snapshot();
+    property<int> plain = 1;
+    EXPECT_EQ(plain.version(), 0u);
+    uint64_t seen = ChangeEpoch::current();
+    plain = 2;
+    uint64_t written = plain.version();
+    EXPECT_GT(written, seen);
+    plain = 2; // same value, not a change
+    EXPECT_EQ(plain.version(), written);
+    plain = 3;
+    EXPECT_GT(plain.version(), written);
+    EXPECT_EQ(PropertyMetrics::snapshot().gauges[PropertyMetrics::Bound], before.gauges[PropertyMetrics::Bound]);
+
+    // the version carries over once the property gets binding state
+    written = plain.version();
+    ChangePoller poller;
+    poller.add(plain);
+    EXPECT_EQ(plain.version(), written);
+    EXPECT_TRUE(poller.changedSince(seen));
+    EXPECT_FALSE(poller.changedSince(written));
+}
+
+TEST(ChangePoller, equalWritesAreSilent) {
+    property<std::string> name = std::string("a");
+    int fired = 0;
+    name.onValueChanged([&fired] { ++fired; });
+    name = std::string("a");
+    name = std::string("a");
+    EXPECT_EQ(fired, 0);
+    name = std::string("b");
+    EXPECT_EQ(fired, 1);
+
+    property<bool> flag = false;
+    flag.onValueChanged([&fired] { ++fired; });
+    flag = 0;
+    EXPECT_EQ(fired, 1);
+    flag = 2;
+    flag = 3;
+    EXPECT_EQ(fired, 2);
+}
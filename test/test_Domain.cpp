@@ -0,0 +1,137 @@
+#include "gtest/gtest.h"
+#include "../src/ChangePoller.hpp"
+#include "../src/Domain.hpp"
+
+#include <latch>
+
+namespace {
+
+// Waits until the domain has run every task posted before the call.
+void settle(PropertyDomain& domain) { domain.invoke([] {}); }
+
+} // namespace
+
+TEST(Domain, tasksRunInOrderOnTheDomainThread) {
+    EXPECT_EQ(PropertyDomain::current(), nullptr);
+    PropertyDomain domain;
+    std::vector<int> order;
+    for(int i = 0; i < 100; ++i)
+        domain.post([&order, i] { order.push_back(i); });
+    EXPECT_EQ(domain.invoke([&] { return PropertyDomain::current(); }), &domain);
+    ASSERT_EQ(order.size(), 100u);
+    for(int i = 0; i < 100; ++i)
+        EXPECT_EQ(order[i], i);
+    EXPECT_NE(domain.invoke([] { return std::this_thread::get_id(); }), std::this_thread::get_id());
+}
+
+TEST(Domain, crossDomainBindingCoalesces) {
+    PropertyDomain a, b;
+    auto source = a.invoke([] { return std::make_unique<property<int>>(1); });
+
+    struct Model {
+        property<int> input;
+        property<int> doubled = input * 2;
+        int waves = 0;
+        DomainBinding binding;
+    };
+    auto model = b.invoke([&] {
+        auto m = std::make_unique<Model>();
+        m->doubled.onValueChanged([m = m.get()] { ++m->waves; });
+        m->binding = b.bind(m->input, a, *source);
+        return m;
+    });
+    settle(a);
+    settle(b);
+    EXPECT_EQ(b.invoke([&] { return model->doubled.value(); }), 2);
+
+    // While b is busy, a burst of writes on a collapses into one delivery.
+    std::latch busy(1), release(1);
+    b.post([&] {
+        busy.count_down();
+        release.wait();
+    });
+    busy.wait();
+    int waves = model->waves;
+    a.invoke([&] {
+        for(int i = 2; i <= 1000; ++i)
+            *source = i;
+    });
+    release.count_down();
+    settle(b);
+    b.invoke([&] {
+        EXPECT_EQ(model->doubled.value(), 2000);
+        EXPECT_EQ(model->waves, waves + 1);
+    });
+
+    b.invoke([&] { model->binding.reset(); });
+    a.invoke([&] { *source = 5; });
+    settle(a);
+    settle(b);
+    EXPECT_EQ(b.invoke([&] { return model->input.value(); }), 1000);
+
+    b.invoke([&] { model.reset(); });
+    a.invoke([&] { source.reset(); });
+}
+
+TEST(Domain, concurrentWriters) {
+    PropertyDomain sink;
+    constexpr int Writers = 4;
+    std::vector<std::unique_ptr<PropertyDomain>> writers;
+    std::vector<std::unique_ptr<property<int>>> sources(Writers);
+    for(int w = 0; w < Writers; ++w) {
+        writers.push_back(std::make_unique<PropertyDomain>());
+        sources[w] = writers[w]->invoke([] { return std::make_unique<property<int>>(0); });
+    }
+
+    struct Model {
+        property<int> inputs[Writers];
+        property<int> sum = inputs[0] + inputs[1] + inputs[2] + inputs[3];
+        std::vector<DomainBinding> bindings;
+    };
+    auto model = sink.invoke([&] {
+        auto m = std::make_unique<Model>();
+        for(int w = 0; w < Writers; ++w)
+            m->bindings.push_back(sink.bind(m->inputs[w], *writers[w], *sources[w]));
+        return m;
+    });
+
+    for(int w = 0; w < Writers; ++w) {
+        writers[w]->post([&, w] {
+            for(int i = 1; i <= 10000; ++i)
+                *sources[w] = i;
+        });
+    }
+    for(auto& w : writers)
+        settle(*w);
+    settle(sink);
+    EXPECT_EQ(sink.invoke([&] { return model->sum.value(); }), 4 * 10000);
+
+    sink.invoke([&] { model.reset(); });
+    for(int w = 0; w < Writers; ++w)
+        writers[w]->invoke([&] { sources[w].reset(); });
+}
+
+TEST(Domain, pollerAcrossDomains) {
+    PropertyDomain domain;
+    auto props = domain.invoke([] { return std::make_unique<std::array<property<int>, 2>>(); });
+    ChangePoller poller;
+    domain.invoke([&] {
+        poller.add((*props)[0]);
+        poller.add((*props)[1]);
+    });
+
+    // The consumer's own thread has moved the epoch well past the domain's writes.
+    property<int> local = 0;
+    local.onValueChanged([] {});
+    for(int i = 1; i <= 100; ++i)
+        local = i;
+    uint64_t seen = ChangeEpoch::current();
+    EXPECT_FALSE(domain.invoke([&] { return poller.changedSince(seen); }));
+
+    domain.invoke([&] { (*props)[1] = 7; });
+    EXPECT_EQ(poller.changedSinceList(seen), std::vector<size_t>{1});
+    seen = ChangeEpoch::current();
+    EXPECT_FALSE(poller.changedSince(seen));
+
+    domain.invoke([&] { props.reset(); });
+}
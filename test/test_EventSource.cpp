@@ -0,0 +1,93 @@
+#include "gtest/gtest.h"
+#include "../src/EventSource.hpp"
+
+#if defined(__linux__)
+
+#include <poll.h>
+#include <sys/epoll.h>
+#include <thread>
+
+namespace {
+
+bool readable(int fd) {
+    pollfd p{fd, POLLIN, 0};
+    return poll(&p, 1, 0) == 1 && (p.revents & POLLIN);
+}
+
+} // namespace
+
+TEST(EventSource, wakesOncePerBurst) {
+    property<int> a = 0;
+    property<std::string> b = std::string("x");
+    property<int> sum = a * 2;
+    PropertyEventSource events;
+    ASSERT_TRUE(events);
+    EXPECT_EQ(events.watch(a), 0u);
+    EXPECT_EQ(events.watch(b), 1u);
+    EXPECT_EQ(events.watch(sum), 2u);
+    EXPECT_FALSE(readable(events.fd()));
+
+    b = std::string("y");
+    EXPECT_TRUE(readable(events.fd()));
+    a = 1;
+    a = 2;
+    uint64_t count = 0;
+    ASSERT_EQ(read(events.fd(), &count, sizeof(count)), static_cast<ssize_t>(sizeof(count)));
+    EXPECT_EQ(count, 1u);
+
+    std::vector<size_t> changed;
+    EXPECT_EQ(events.drain(changed), 3u);
+    EXPECT_EQ(changed, (std::vector<size_t>{0, 1, 2}));
+    EXPECT_FALSE(readable(events.fd()));
+    changed.clear();
+    EXPECT_EQ(events.drain(changed), 0u);
+
+    b = std::string("z");
+    EXPECT_TRUE(readable(events.fd()));
+    EXPECT_EQ(events.drain([](size_t i) { EXPECT_EQ(i, 1u); }), 1u);
+    EXPECT_FALSE(readable(events.fd()));
+}
+
+TEST(EventSource, epollAcrossThreads) {
+    property<int> counter = 0;
+    PropertyEventSource events;
+    events.watch(counter);
+
+    int ep = epoll_create1(EPOLL_CLOEXEC);
+    ASSERT_GE(ep, 0);
+    epoll_event ev{};
+    ev.events = EPOLLIN;
+    ASSERT_EQ(epoll_ctl(ep, EPOLL_CTL_ADD, events.fd(), &ev), 0);
+
+    std::atomic<bool> done = false;
+    std::thread writer([&] {
+        for(int i = 1; i <= 1000; ++i)
+            counter = i;
+        done = true;
+    });
+    size_t drained = 0;
+    while(true) {
+        bool finished = done.load();
+        epoll_event out{};
+        if(epoll_wait(ep, &out, 1, 1000) == 1)
+            drained += events.drain([](size_t) {});
+        if(finished && !readable(events.fd()))
+            break;
+    }
+    writer.join();
+    close(ep);
+    EXPECT_GE(drained, 1u);
+    EXPECT_LE(drained, 1000u);
+    EXPECT_EQ(events.drain([](size_t) {}), 0u);
+}
+
+TEST(EventSource, outlivedProperty) {
+    property<int> kept = 0;
+    {
+        PropertyEventSource events;
+        events.watch(kept);
+    }
+    kept = 1; // the observer went away with the source
+}
+
+#endif
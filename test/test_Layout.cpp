@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+#include "../src/Layout.hpp"
+
+TEST(Layout, anchors) {
+    Item window{0, 0, 800, 600};
+    Item header{0, 0, 0, 40};
+    Item body;
+    Rectangle badge{0, 0, 20, 10, 0xff0000};
+
+    LayoutEngine layout;
+    layout.anchor(header, Edge::Left, window, Edge::Left);
+    layout.anchor(header, Edge::Right, window, Edge::Right);
+    layout.anchor(header, Edge::Top, window, Edge::Top);
+    layout.fill(body, window, 8);
+    layout.anchor(body, Edge::Top, header, Edge::Bottom, 4);
+    layout.centerIn(badge, header);
+    ASSERT_TRUE(layout.solve());
+
+    EXPECT_EQ(header.width.value(), 800);
+    EXPECT_EQ(body.x.value(), 8);
+    EXPECT_EQ(body.y.value(), 44);
+    EXPECT_EQ(body.width.value(), 784);
+    EXPECT_EQ(body.height.value(), 548);
+    EXPECT_EQ(badge.x.value(), 390);
+    EXPECT_EQ(badge.y.value(), 15);
+
+    window.width = 1000;
+    window.height = 700;
+    ASSERT_TRUE(layout.solve());
+    EXPECT_EQ(header.width.value(), 1000);
+    EXPECT_EQ(body.height.value(), 648);
+    EXPECT_EQ(badge.x.value(), 490);
+}
+
+TEST(Layout, containers) {
+    Item toolbar{10, 20, 0, 0};
+    Item a{0, 0, 30, 10}, b{0, 0, 50, 25}, c{0, 0, 20, 5};
+    Item panel{0, 100, 0, 0};
+    Item p, q, r;
+    for(Item* cell : {&p, &q, &r}) {
+        cell->width = 10;
+        cell->height = 10;
+    }
+
+    LayoutEngine layout;
+    layout.row(toolbar, {.spacing = 5, .padding = 2}, a, b, c);
+    layout.grid(panel, 2, {.spacing = 1}, p, q, r);
+    ASSERT_TRUE(layout.solve());
+
+    EXPECT_EQ(a.x.value(), 12);
+    EXPECT_EQ(b.x.value(), 47);
+    EXPECT_EQ(c.x.value(), 102);
+    EXPECT_EQ(c.y.value(), 22);
+    EXPECT_EQ(toolbar.width.value(), 114);
+    EXPECT_EQ(toolbar.height.value(), 29);
+
+    EXPECT_EQ(q.x.value(), 11);
+    EXPECT_EQ(r.x.value(), 0);
+    EXPECT_EQ(r.y.value(), 111);
+    EXPECT_EQ(panel.width.value(), 21);
+    EXPECT_EQ(panel.height.value(), 21);
+
+    q.width = 30;
+    ASSERT_TRUE(layout.solve());
+    EXPECT_EQ(panel.width.value(), 61);
+    EXPECT_EQ(q.x.value(), 31);
+}
+
+TEST(Layout, onlyDirtyRegionIsSolved) {
+    Item root{0, 0, 100, 100};
+    std::vector<Item> left(50), right(50);
+    LayoutEngine layout;
+    Item leftCol, rightCol;
+    layout.anchor(leftCol, Edge::Left, root, Edge::Left);
+    layout.anchor(rightCol, Edge::Left, root, Edge::Right);
+    for(size_t i = 0; i < left.size(); ++i) {
+        layout.anchor(left[i], Edge::Left, leftCol, Edge::Left, static_cast<int>(i));
+        layout.anchor(right[i], Edge::Left, rightCol, Edge::Left, static_cast<int>(i));
+    }
+    ASSERT_TRUE(layout.solve());
+    EXPECT_EQ(right[3].x.value(), 103);
+
+    int fired = 0;
+    for(auto& item : left)
+        item.x.onValueChanged([&fired] { ++fired; });
+
+    root.width = 200;
+    ASSERT_TRUE(layout.solve());
+    EXPECT_EQ(right[3].x.value(), 203);
+    EXPECT_EQ(fired, 0);
+    EXPECT_EQ(layout.evaluated(), right.size() + 1);
+
+    ASSERT_TRUE(layout.solve());
+    EXPECT_EQ(layout.evaluated(), 0u);
+}
+
+TEST(Layout, cycleIsRejected) {
+    Item a{0, 0, 10, 10}, b{0, 0, 10, 10};
+    LayoutEngine layout;
+    layout.anchor(a, Edge::Left, b, Edge::Right);
+    layout.anchor(b, Edge::Left, a, Edge::Right);
+    EXPECT_FALSE(layout.solve());
+    EXPECT_EQ(a.x.value(), 0);
+}
+
+TEST(Layout, engineDisconnectsWhenDestroyed) {
+    Item window{0, 0, 800, 600};
+    Item body;
+    auto before = PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers];
+    {
+        LayoutEngine layout;
+        layout.fill(body, window, 8);
+        ASSERT_TRUE(layout.solve());
+        EXPECT_EQ(PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers], before + 8);
+    }
+    EXPECT_EQ(PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers], before);
+    window.width = 1000;
+    EXPECT_EQ(body.width.value(), 784);
+}
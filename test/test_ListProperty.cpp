@@ -0,0 +1,201 @@
+#include "gtest/gtest.h"
+#include <string>
+#include <vector>
+#include "../src/ListProperty.hpp"
+
+namespace {
+
+// Applies diffs to a shadow copy, the way a view layer would.
+template <class T>
+struct Mirror {
+    std::vector<T> rows;
+    int changes = 0;
+
+    void apply(const BasicList<T>& list, const ListChange& c) {
+        ++changes;
+        switch(c.kind) {
+        case ChangeKind::Insert:
+            rows.insert(rows.begin() + c.first, list.begin() + c.first, list.begin() + c.first + c.count);
+            break;
+        case ChangeKind::Erase:
+            rows.erase(rows.begin() + c.first, rows.begin() + c.first + c.count);
+            break;
+        case ChangeKind::Update:
+            for(size_t i = c.first; i < c.first + c.count; ++i)
+                rows[i] = list[i];
+            break;
+        case ChangeKind::Reset:
+            rows = list.value();
+            break;
+        }
+    }
+};
+
+} // namespace
+
+TEST(ListProperty, diffs) {
+    list_property<int> list = {1, 2, 3};
+    std::vector<ListChange> changes;
+    list.onListChanged([&](const ListChange& c) { changes.push_back(c); });
+    int notified = 0;
+    list.onValueChanged([&] { ++notified; });
+
+    list.push_back(4);
+    list.insert(0, 0);
+    list.set(2, 20);
+    list.modify(3, [](int& v) { v *= 10; });
+    list.erase(1, 2);
+
+    EXPECT_EQ(list.value(), (std::vector<int>{0, 30, 4}));
+    ASSERT_EQ(changes.size(), 5u);
+    EXPECT_EQ(changes[0].kind, ChangeKind::Insert);
+    EXPECT_EQ(changes[0].first, 3u);
+    EXPECT_EQ(changes[1].kind, ChangeKind::Insert);
+    EXPECT_EQ(changes[1].first, 0u);
+    EXPECT_EQ(changes[2].kind, ChangeKind::Update);
+    EXPECT_EQ(changes[2].first, 2u);
+    EXPECT_EQ(changes[3].kind, ChangeKind::Update);
+    EXPECT_EQ(changes[4].kind, ChangeKind::Erase);
+    EXPECT_EQ(changes[4].first, 1u);
+    EXPECT_EQ(changes[4].count, 2u);
+    EXPECT_EQ(notified, 5);
+
+    // out of range erases are ignored
+    changes.clear();
+    list.erase(3);
+    list.erase(7, 2);
+    list.clear();
+    list.pop_back();
+    EXPECT_TRUE(list.empty());
+    ASSERT_EQ(changes.size(), 1u);
+    EXPECT_EQ(changes[0].count, 3u);
+
+    int connected = 0;
+    Connection c = list.connectListChanged([&connected](const ListChange&) { ++connected; });
+    list.push_back(1);
+    c.disconnect();
+    list.push_back(2);
+    EXPECT_EQ(connected, 1);
+    EXPECT_EQ(changes.size(), 3u);
+}
+
+TEST(ListProperty, filtered) {
+    list_property<int> list = {1, 2, 3, 4, 5, 6};
+    auto even = filtered(list, [](int v) { return v % 2 == 0; });
+    EXPECT_EQ(even.value(), (std::vector<int>{2, 4, 6}));
+
+    Mirror<int> mirror{even.value()};
+    even.onListChanged([&](const ListChange& c) { mirror.apply(even, c); });
+
+    list.insert(1, 8);  // 1 8 2 3 4 5 6
+    list.push_back(7);  // odd, no diff
+    list.set(0, 10);    // 10 8 2 3 4 5 6 7
+    list.set(2, 9);     // 10 8 9 3 4 5 6 7
+    list.erase(3, 3);   // 10 8 9 6 7
+
+    EXPECT_EQ(even.value(), (std::vector<int>{10, 8, 6}));
+    EXPECT_EQ(mirror.rows, even.value());
+    EXPECT_EQ(mirror.changes, 4);
+    EXPECT_EQ(list[even.sourceIndex(2)], 6);
+}
+
+TEST(ListProperty, sortedAndMapped) {
+    list_property<int> list = {5, 1, 4};
+    auto asc = sorted(list);
+    auto names = mapped(asc, [](int v) { return std::to_string(v); });
+    EXPECT_EQ(asc.value(), (std::vector<int>{1, 4, 5}));
+
+    Mirror<std::string> mirror{names.value()};
+    names.onListChanged([&](const ListChange& c) { mirror.apply(names, c); });
+
+    list.push_back(3);
+    list.set(0, 0);
+    list.erase(1);
+    list.modify(1, [](int& v) { v = 2; });
+
+    EXPECT_EQ(list.value(), (std::vector<int>{0, 2, 3}));
+    EXPECT_EQ(asc.value(), (std::vector<int>{0, 2, 3}));
+    EXPECT_EQ(names.value(), (std::vector<std::string>{"0", "2", "3"}));
+    EXPECT_EQ(mirror.rows, names.value());
+
+    list.assign({9, 8});
+    EXPECT_EQ(names.value(), (std::vector<std::string>{"8", "9"}));
+    EXPECT_EQ(mirror.rows, names.value());
+}
+
+TEST(ListProperty, viewLifetime) {
+    list_property<int> list = {1, 2};
+    {
+        auto view = filtered(list, [](int) { return true; });
+        list.push_back(3);
+        EXPECT_EQ(view.size(), 3u);
+    }
+    list.push_back(4);
+    EXPECT_EQ(list.size(), 4u);
+
+    // views disconnect from the source as soon as they are destroyed
+    auto before = PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers];
+    {
+        auto view = sorted(list);
+        auto doubled = mapped(view, [](int v) { return v * 2; });
+        EXPECT_EQ(PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers], before + 2);
+    }
+    EXPECT_EQ(PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers], before);
+
+    // and may be destroyed by an observer of the source's own changes
+    auto view = std::make_unique<FilteredList<int, bool (*)(int)>>(list, [](int v) { return v > 2; });
+    list.onListChanged([&view](const ListChange&) { view.reset(); });
+    list.push_back(5);
+    EXPECT_EQ(view, nullptr);
+    list.push_back(6);
+}
+
+TEST(MapProperty, diffs) {
+    map_property<std::string, int> map = {{"a", 1}};
+    std::vector<std::pair<ChangeKind, std::string>> changes;
+    map.onMapChanged([&](const MapChange<std::string>& c) {
+        changes.emplace_back(c.kind, c.key ? *c.key : std::string());
+    });
+
+    map.set("b", 2);
+    map.set("a", 10);
+    map.modify("b", [](int& v) { ++v; });
+    EXPECT_TRUE(map.erase("a"));
+    EXPECT_FALSE(map.erase("a"));
+    map.clear();
+
+    ASSERT_EQ(changes.size(), 5u);
+    EXPECT_EQ(changes[0], std::make_pair(ChangeKind::Insert, std::string("b")));
+    EXPECT_EQ(changes[1], std::make_pair(ChangeKind::Update, std::string("a")));
+    EXPECT_EQ(changes[2], std::make_pair(ChangeKind::Update, std::string("b")));
+    EXPECT_EQ(changes[3], std::make_pair(ChangeKind::Erase, std::string("a")));
+    EXPECT_EQ(changes[4].first, ChangeKind::Reset);
+    EXPECT_TRUE(map.empty());
+}
+
+TEST(ListProperty, computed) {
+    list_property<int> list = {1, 2, 3};
+    property<int> limit = 2;
+    property<int> below = computed([&] {
+        int n = 0;
+        for(int v : list)
+            n += v < limit.value();
+        return n;
+    });
+    int fired = 0;
+    below.onValueChanged([&fired] { ++fired; });
+    EXPECT_EQ(below.value(), 1);
+    list.push_back(0);
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(below.value(), 2);
+    limit = 3;
+    EXPECT_EQ(below.value(), 3);
+
+    // an empty list never reads limit
+    list.clear();
+    fired = 0;
+    limit = 10;
+    EXPECT_EQ(fired, 0);
+    list.push_back(4);
+    EXPECT_EQ(below.value(), 1);
+}
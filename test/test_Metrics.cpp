@@ -0,0 +1,138 @@
+#include "gtest/gtest.h"
+#include "../src/Property.hpp"
+
+#include <deque>
+#include <thread>
+
+namespace {
+
+int64_t gaugeDelta(const PropertyMetrics::Snapshot& now, const PropertyMetrics::Snapshot& before, PropertyMetrics::Gauge g) {
+    return now.gauges[g] - before.gauges[g];
+}
+
+uint64_t counterDelta(const PropertyMetrics::Snapshot& now, const PropertyMetrics::Snapshot& before, PropertyMetrics::Counter c) {
+    return now.counters[c] - before.counters[c];
+}
+
+} // namespace
+
+TEST(Metrics, liveGauges) {
+    auto before = PropertyMetrics::snapshot();
+    {
+        property<int> a = 1;
+        property<int> b = 2;
+        auto plain = PropertyMetrics::snapshot();
+        EXPECT_EQ(gaugeDelta(plain, before, PropertyMetrics::Properties), 2);
+        EXPECT_EQ(gaugeDelta(plain, before, PropertyMetrics::Bound), 0);
+        EXPECT_EQ(gaugeDelta(plain, before, PropertyMetrics::Bytes), 0);
+
+        property<int> sum = a + b;
+        sum.onValueChanged([] {});
+        auto bound = PropertyMetrics::snapshot();
+        EXPECT_EQ(gaugeDelta(bound, before, PropertyMetrics::Properties), 3);
+        EXPECT_EQ(gaugeDelta(bound, before, PropertyMetrics::Bound), 3);
+        EXPECT_EQ(gaugeDelta(bound, before, PropertyMetrics::Data), 3);
+        EXPECT_EQ(gaugeDelta(bound, before, PropertyMetrics::Links), 2);
+        EXPECT_EQ(gaugeDelta(bound, before, PropertyMetrics::Observers), 1);
+        EXPECT_GT(gaugeDelta(bound, before, PropertyMetrics::Bytes), 0);
+
+        sum = 7; // unbinds
+        EXPECT_EQ(gaugeDelta(PropertyMetrics::snapshot(), before, PropertyMetrics::Links), 0);
+    }
+    auto after = PropertyMetrics::snapshot();
+    for(int g = 0; g < PropertyMetrics::GaugeCount; ++g)
+        EXPECT_EQ(gaugeDelta(after, before, static_cast<PropertyMetrics::Gauge>(g)), 0) << g;
+}
+
+TEST(Metrics, wavesAndFanout) {
+    property<int> a = 0;
+    property<int> b = a + 1;
+    property<int> c = a * 2;
+    c.onValueChanged([] {});
+    a = 1; // first write allocates the wave buffers
+
+    PropertyMetrics::enableTiming(true);
+    auto before = PropertyMetrics::snapshot();
+    for(int i = 2; i < 12; ++i)
+        a = i;
+    auto after = PropertyMetrics::snapshot();
+    PropertyMetrics::enableTiming(false);
+
+    EXPECT_EQ(counterDelta(after, before, PropertyMetrics::Writes), 10u);
+    EXPECT_EQ(counterDelta(after, before, PropertyMetrics::Waves), 10u);
+    EXPECT_EQ(counterDelta(after, before, PropertyMetrics::Fired), 30u);
+    EXPECT_EQ(after.fanout.count - before.fanout.count, 10u);
+    EXPECT_EQ(after.fanout.buckets[3] - before.fanout.buckets[3], 10u);
+    EXPECT_EQ(after.latencyNs.count - before.latencyNs.count, 10u);
+    EXPECT_GT(after.rate(PropertyMetrics::Waves, before), 0.0);
+
+    a = 20;
+    EXPECT_EQ(PropertyMetrics::snapshot().latencyNs.count, after.latencyNs.count);
+}
+
+TEST(Metrics, mergesExitedThreads) {
+    auto before = PropertyMetrics::snapshot();
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 4; ++t) {
+        threads.emplace_back([] {
+            property<int> p = 0;
+            for(int i = 0; i < 1000; ++i)
+                p = i;
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    auto after = PropertyMetrics::snapshot();
+    EXPECT_EQ(counterDelta(after, before, PropertyMetrics::Writes), 4000u);
+    EXPECT_EQ(gaugeDelta(after, before, PropertyMetrics::Properties), 0);
+}
+
+TEST(Metrics, concurrentExitsKeepGauges) {
+    auto before = PropertyMetrics::snapshot();
+    std::vector<std::thread> threads;
+    for(int t = 0; t < 8; ++t) {
+        threads.emplace_back([] {
+            // Constructed before the thread's first metric, so destroyed after
+            // its block: the properties are counted out in the shared orphan.
+            thread_local std::deque<property<int>> late;
+            for(int i = 0; i < 5000; ++i)
+                late.emplace_back(i);
+        });
+    }
+    for(auto& t : threads)
+        t.join();
+    auto after = PropertyMetrics::snapshot();
+    EXPECT_EQ(gaugeDelta(after, before, PropertyMetrics::Properties), 0);
+}
+
+TEST(Metrics, histogramBuckets) {
+    using H = PropertyMetrics::Histogram;
+    for(uint64_t v : {0ull, 1ull, 3ull, 4ull, 5ull, 7ull, 8ull, 100ull, 1000ull, 123456789ull, ~0ull}) {
+        uint64_t upper = H::upperBound(H::bucket(v));
+        EXPECT_GE(upper, v);
+        EXPECT_LE(upper - v, v / 4) << v;
+    }
+    H h;
+    for(uint64_t v = 1; v <= 100; ++v) {
+        ++h.buckets[H::bucket(v)];
+        ++h.count;
+        h.sum += v;
+    }
+    EXPECT_GE(h.quantile(0.5), 50u);
+    EXPECT_LE(h.quantile(0.5), 63u);
+    EXPECT_GE(h.quantile(1), 100u);
+    EXPECT_EQ(H().quantile(0.5), 0u);
+}
+
+TEST(Metrics, textExport) {
+    auto before = PropertyMetrics::snapshot();
+    property<int> a = 0;
+    property<int> b = a + 1;
+    a = 1;
+    auto now = PropertyMetrics::snapshot();
+    std::string text = now.text(&before);
+    for(const char* name : {"property_live_properties ", "property_bytes ", "property_writes_total ", "property_waves_per_second ",
+                            "property_propagation_latency_ns{quantile=\"0.99\"} ", "property_wave_fanout_count "})
+        EXPECT_NE(text.find(name), std::string::npos) << name;
+    EXPECT_EQ(now.text().find("_per_second"), std::string::npos);
+}
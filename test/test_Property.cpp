@@ -1,4 +1,5 @@
 #include "gtest/gtest.h"
+#include <iostream>
 #include <iterator>
 #include <memory>
 #include <string>
@@ -245,3 +246,430 @@ TEST(Property, readonly) {
     b = 6;
     // a = 6;  //a is readonly
 }
+
+TEST(Property, ref) {
+    property<std::string> a = "label";
+    EXPECT_EQ(&a.ref().get(), &a.ref().get());
+    EXPECT_FALSE(a.ref().owned());
+
+    property<std::string> b = a;
+    property<std::string> c = b;
+    EXPECT_FALSE(c.ref().owned());
+    EXPECT_EQ(&c.ref().get(), &a.ref().get());
+
+    property<std::string> d = a + std::string("!");
+    EXPECT_TRUE(d.ref().owned());
+    EXPECT_EQ(*d.ref(), "label!");
+
+    std::string seen;
+    c.onValueChanged([&seen](const std::string& v) { seen = v; });
+    a = std::string("text");
+    EXPECT_EQ(seen, "text");
+    EXPECT_EQ(*d.ref(), "text!");
+}
+
+TEST(Property, footprint) {
+    EXPECT_LE(sizeof(property<int>), 2 * sizeof(void*));
+    property<int> a = 1;
+    property<int> b = 2;
+    property<int> sum = a + b;
+    EXPECT_EQ(sum.value(), 3);
+    a = 5;
+    EXPECT_EQ(sum.value(), 7);
+    property<int> alias = b;
+    b = 4;
+    EXPECT_EQ(alias.value(), 4);
+    EXPECT_EQ(sum.value(), 9);
+
+    property<int> moved = std::move(a);
+    EXPECT_EQ(moved.value(), 5);
+    property<int> fresh = 3;
+    fresh = std::move(moved);
+    EXPECT_EQ(fresh.value(), 5);
+}
+
+TEST(Property, diamond) {
+    property<int> a = 1;
+    property<int> b = a + 1;
+    property<int> c = a * 2;
+    property<int> d = b + c;
+    std::vector<int> seen;
+    d.onValueChanged([&seen](int v) { seen.push_back(v); });
+    a = 2;
+    EXPECT_EQ(seen, std::vector<int>{7});
+}
+
+TEST(Property, batch) {
+    property<int> a = 1;
+    property<int> b = 2;
+    property<int> sum = a + b;
+    int fired = 0;
+    sum.onValueChanged([&fired] { ++fired; });
+    {
+        PropertyBatch batch;
+        a = 10;
+        b = 20;
+        {
+            PropertyBatch nested;
+            a = 30;
+        }
+        EXPECT_EQ(fired, 0);
+    }
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(sum.value(), 50);
+}
+
+TEST(Property, scheduler) {
+    property<int> a = 0;
+    property<int> b = a + 1;
+    property<int> c = a * 2;
+    property<int> d = b + c;
+    std::vector<int> seen;
+    d.onValueChanged([&seen](int v) { seen.push_back(v); });
+
+    property<int> echo = 0;
+    a.onValueChanged([&echo](int v) { echo = v; });
+    int echoed = 0;
+    echo.onValueChanged([&echoed] { ++echoed; });
+
+    NotifyScheduler scheduler;
+    EXPECT_EQ(NotifyScheduler::current(), &scheduler);
+    for(int i = 1; i <= 200; ++i)
+        a = i;
+    EXPECT_TRUE(seen.empty());
+    EXPECT_EQ(scheduler.pending(), 1u);
+
+    EXPECT_EQ(scheduler.flush(), 1u);
+    EXPECT_EQ(seen, std::vector<int>{601});
+    EXPECT_EQ(echoed, 0);
+    EXPECT_EQ(scheduler.pending(), 1u);
+
+    scheduler.flush();
+    EXPECT_EQ(echoed, 1);
+    EXPECT_EQ(seen.size(), 1u);
+    EXPECT_EQ(scheduler.flush(), 0u);
+}
+
+TEST(Property, priority) {
+    property<int> a = 0;
+    property<int> b = a + 1;
+    std::vector<std::string> order;
+    a.onValueChanged(ObserverPriority::Idle, [&order] { order.push_back("log"); });
+    a.onValueChanged([&order] { order.push_back("normal"); });
+    b.onValueChanged(ObserverPriority::Immediate, [&order] { order.push_back("input"); });
+    a = 1;
+    EXPECT_EQ(order, (std::vector<std::string>{"input", "normal", "log"}));
+
+    order.clear();
+    IdleQueue idle;
+    a = 2;
+    a = 3;
+    EXPECT_EQ(order, (std::vector<std::string>{"input", "normal", "input", "normal"}));
+    EXPECT_EQ(idle.pending(), 1u);
+    EXPECT_EQ(idle.drain(std::chrono::milliseconds(1)), 1u);
+    EXPECT_EQ(order.back(), "log");
+    EXPECT_EQ(idle.pending(), 0u);
+}
+
+TEST(Property, connection) {
+    property<int> a = 0;
+    int first = 0, second = 0;
+    Connection c = a.connect([&first] { ++first; });
+    {
+        ScopedConnection scoped = a.connect([&second](int v) { second = v; });
+        a = 1;
+        EXPECT_TRUE(scoped.connected());
+    }
+    a = 2;
+    EXPECT_EQ(first, 2);
+    EXPECT_EQ(second, 1);
+
+    c.disconnect();
+    EXPECT_FALSE(c.connected());
+    c.disconnect();
+    a = 3;
+    EXPECT_EQ(first, 2);
+
+    // an observer disconnecting itself and a later one while firing
+    Connection self, next;
+    int calls = 0;
+    self = a.connect([&] {
+        ++calls;
+        self.disconnect();
+        next.disconnect();
+    });
+    next = a.connect([&calls] { calls += 100; });
+    a = 4;
+    a = 5;
+    EXPECT_EQ(calls, 1);
+
+    Connection orphan;
+    {
+        property<int> gone = 0;
+        orphan = gone.connect([] {});
+        EXPECT_TRUE(orphan.connected());
+    }
+    EXPECT_FALSE(orphan.connected());
+    orphan.disconnect();
+
+    // moving hands the observer over; only the new owner can unlink it
+    static_assert(!std::is_copy_constructible_v<Connection>);
+    int moved = 0;
+    Connection from = a.connect([&moved] { ++moved; });
+    Connection to = std::move(from);
+    EXPECT_FALSE(from.connected());
+    from.disconnect();
+    a = 6;
+    EXPECT_EQ(moved, 1);
+    to.disconnect();
+    EXPECT_FALSE(to.connected());
+    a = 7;
+    EXPECT_EQ(moved, 1);
+}
+
+TEST(Property, context) {
+    property<int> a = 0;
+    property<int> b = a * 2;
+    int fired = 0;
+    {
+        BindingContext screen;
+        for(int i = 0; i < 1000; ++i) {
+            a.onValueChanged(screen, [&fired] { ++fired; });
+            b.onValueChanged(screen, [&fired](int) { ++fired; });
+        }
+        EXPECT_EQ(screen.size(), 2000u);
+        a = 1;
+        EXPECT_EQ(fired, 2000);
+    }
+    a = 2;
+    EXPECT_EQ(fired, 2000);
+
+    BindingContext reused;
+    a.onValueChanged(reused, [&fired] { ++fired; });
+    reused.reset();
+    a.onValueChanged(reused, [&fired] { fired += 10; });
+    a = 3;
+    EXPECT_EQ(fired, 2010);
+}
+
+TEST(Property, disconnectAfterReassignment) {
+    property<int> a = 1;
+    property<int> other = 2;
+    // Each step leaves b on fresh data through a different path; the observers
+    // registered before it must still be removable afterwards.
+    std::vector<std::function<void(property<int>&)>> paths = {
+        [](property<int>& b) { b = 5; },                                  // assign() on an alias
+        [&other](property<int>& b) { b = other; },                        // operator=(const P&)
+        [](property<int>& b) { b = b + 1; },                              // binding that reads b
+        [&a](property<int>& b) { b = computed([&a] { return a.value(); }); } // computed over an alias
+    };
+    for(size_t i = 0; i < paths.size(); ++i) {
+        property<int> b = a;
+        if(i == 2)
+            b = other;
+        int plain = 0, scoped = 0;
+        Connection c = b.connect([&plain] { ++plain; });
+        auto context = std::make_unique<BindingContext>();
+        b.onValueChanged(*context, [&scoped] { ++scoped; });
+
+        paths[i](b);
+        EXPECT_TRUE(c.connected()) << i;
+        EXPECT_EQ(plain, 1) << i;
+        EXPECT_EQ(scoped, 1) << i;
+
+        c.disconnect();
+        context.reset();
+        EXPECT_FALSE(c.connected()) << i;
+        b = 42;
+        a = a.value() + 1;
+        other = other.value() + 1;
+        EXPECT_EQ(plain, 1) << i;
+        EXPECT_EQ(scoped, 1) << i;
+    }
+}
+
+TEST(Property, rebind) {
+    property<int> a = 1;
+    property<int> b = 10;
+    property<int> mode = a + 1;
+    property<int> label = mode * 100;
+    int fired = 0;
+    mode.onValueChanged([&fired] { ++fired; });
+    label.onValueChanged([&fired] { ++fired; });
+    EXPECT_EQ(label.value(), 200);
+
+    mode = b + 2; // dependents follow the new expression
+    EXPECT_EQ(fired, 2);
+    EXPECT_EQ(label.value(), 1200);
+    a = 5; // no longer upstream
+    EXPECT_EQ(fired, 2);
+    b = 20;
+    EXPECT_EQ(fired, 4);
+    EXPECT_EQ(label.value(), 2200);
+
+    mode = a + b; // keeps the link to b, adds one to a
+    EXPECT_EQ(label.value(), 2500);
+    fired = 0;
+    a = 6;
+    b = 21;
+    EXPECT_EQ(fired, 4);
+    EXPECT_EQ(label.value(), 2700);
+
+    mode = 3; // a stored value drops every upstream link
+    fired = 0;
+    a = 7;
+    EXPECT_EQ(fired, 0);
+    EXPECT_EQ(label.value(), 300);
+
+    // Reading itself snapshots the old value instead of closing a cycle, and
+    // the dependents keep the data they were bound to.
+    property<int> counter = 1;
+    property<int> twice = counter * 2;
+    counter = counter + 1;
+    EXPECT_EQ(counter.value(), 2);
+    EXPECT_EQ(twice.value(), 2);
+    counter = twice + 1;
+    EXPECT_EQ(counter.value(), 3);
+}
+
+namespace {
+int s_evaluations = 0;
+
+struct Counted {
+    int v = 0;
+    bool operator==(const Counted&) const = default;
+    friend Counted operator+(const Counted& a, int b) {
+        ++s_evaluations;
+        return {a.v + b};
+    }
+};
+} // namespace
+
+TEST(Property, teardown) {
+    auto build = [](auto& source, auto& mid, auto& leaf) {
+        source = std::make_unique<property<Counted>>(Counted{1});
+        mid = std::make_unique<property<Counted>>(*source + 1);
+        leaf = std::make_unique<property<Counted>>(*mid + 1);
+        s_evaluations = 0;
+    };
+    std::unique_ptr<property<Counted>> source, mid, leaf;
+
+    // leaf still holds mid's data, so mid snapshots its value when it dies
+    build(source, mid, leaf);
+    source.reset();
+    mid.reset();
+    leaf.reset();
+    EXPECT_EQ(s_evaluations, 1);
+
+    // dying from the leaves up, no data is shared any more
+    build(source, mid, leaf);
+    leaf.reset();
+    mid.reset();
+    source.reset();
+    EXPECT_EQ(s_evaluations, 0);
+
+    build(source, mid, leaf);
+    {
+        PropertyTeardown teardown;
+        source.reset();
+        mid.reset();
+        leaf.reset();
+    }
+    EXPECT_EQ(s_evaluations, 0);
+
+    // only data a survivor still reads is frozen, once the scope ends
+    build(source, mid, leaf);
+    property<Counted> kept = *mid + 10;
+    {
+        PropertyTeardown teardown;
+        source.reset();
+        mid.reset();
+        leaf.reset();
+        EXPECT_EQ(s_evaluations, 0);
+    }
+    EXPECT_EQ(s_evaluations, 1);
+    EXPECT_EQ(kept.value().v, 12);
+}
+
+TEST(Property, computed) {
+    property<int> a = 3;
+    property<int> b = 7;
+    property<bool> useA = true;
+    property<int> unrelated = 0;
+    property<int> pick = computed([&] { return useA.value() ? a.value() : b.value(); });
+    property<std::string> label = computed([&] { return std::to_string(std::max(a.value(), pick.value())); });
+    int fired = 0;
+    pick.onValueChanged([&fired] { ++fired; });
+    EXPECT_EQ(pick.value(), 3);
+    EXPECT_EQ(label.value(), "3");
+
+    b = 8; // not read while useA holds
+    unrelated = 1;
+    EXPECT_EQ(fired, 0);
+    a = 4;
+    EXPECT_EQ(fired, 1);
+    EXPECT_EQ(label.value(), "4");
+
+    useA = false; // the branch now reads b, and a is dropped
+    EXPECT_EQ(fired, 2);
+    EXPECT_EQ(pick.value(), 8);
+    a = 5;
+    EXPECT_EQ(fired, 2);
+    b = 9;
+    EXPECT_EQ(fired, 3);
+    EXPECT_EQ(label.value(), "9");
+
+    pick = 1; // a stored value ends the tracking
+    b = 10;
+    useA = true;
+    EXPECT_EQ(fired, 4);
+    EXPECT_EQ(label.value(), "5");
+
+    // a plain binding downstream of a computed one follows it
+    property<int> twice = pick * 2;
+    pick = computed([&] { return a.value() + unrelated.value(); });
+    EXPECT_EQ(twice.value(), 12);
+    unrelated = 2;
+    EXPECT_EQ(twice.value(), 14);
+    EXPECT_EQ(fired, 6);
+}
+
+TEST(Property, aliasChain) {
+    property<int> root = 1;
+    std::vector<std::unique_ptr<property<int>>> chain;
+    chain.push_back(std::make_unique<property<int>>(root));
+    for(int i = 1; i < 10; ++i)
+        chain.push_back(std::make_unique<property<int>>(*chain.back()));
+    property<double> converted = *chain.back();
+    int fired = 0;
+    chain.back()->onValueChanged([&fired] { ++fired; });
+
+    root = 2;
+    for(auto& p : chain)
+        EXPECT_EQ(p->value(), 2);
+    EXPECT_EQ(converted.value(), 2.0);
+    EXPECT_EQ(fired, 1);
+
+    // the aliases made from chain[4] follow it from now on
+    *chain[4] = 7;
+    EXPECT_EQ(fired, 2);
+    EXPECT_EQ(chain[3]->value(), 2);
+    for(int i = 4; i < 10; ++i)
+        EXPECT_EQ(chain[i]->value(), 7);
+    root = 3;
+    EXPECT_EQ(chain[3]->value(), 3);
+    EXPECT_EQ(chain[9]->value(), 7);
+    EXPECT_EQ(fired, 2);
+
+    // the aliases made from a dead property keep its last value
+    chain[6].reset();
+    *chain[4] = 8;
+    EXPECT_EQ(chain[5]->value(), 8);
+    EXPECT_EQ(chain[7]->value(), 7);
+    EXPECT_EQ(chain[9]->value(), 7);
+    EXPECT_EQ(converted.value(), 7.0);
+
+    *chain[8] = 9;
+    EXPECT_EQ(chain[9]->value(), 9);
+    EXPECT_EQ(converted.value(), 9.0);
+}
@@ -0,0 +1,119 @@
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "../src/Recorder.hpp"
+
+namespace {
+
+struct Model {
+    property<int> x = 0;
+    property<int> width = 10;
+    property<std::string> name = "a";
+    property<int> right = x + width;
+    property<bool> wide = width > 50;
+};
+
+} // namespace
+
+TEST(Recorder, recordAndReplay) {
+    Model model;
+    int rightChanges = 0;
+    model.right.onValueChanged([&rightChanges] { ++rightChanges; });
+
+    ChangeRecorder recorder;
+    recorder.track("x", model.x);
+    recorder.track("width", model.width);
+    recorder.track("name", model.name);
+    recorder.start();
+    model.x = 5;
+    model.width = 100;
+    model.name = std::string("button");
+    model.name = std::string(40, 'n');
+    recorder.stop();
+    model.x = 7; // not recorded
+
+    auto events = recorder.events();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(events[0].key, PropertySnapshot::key("x"));
+    EXPECT_GE(events[1].fired, 2u);
+    EXPECT_LE(events[0].time, events[1].time);
+    EXPECT_TRUE(events[3].flags & ChangeEvent::Truncated);
+
+    std::string path = ::testing::TempDir() + "property_changes.bin";
+    ASSERT_TRUE(recorder.dump(path));
+    auto loaded = ChangeRecorder::load(path);
+    std::remove(path.c_str());
+    ASSERT_EQ(loaded.size(), events.size());
+
+    Model rebuilt;
+    ChangeReplayer replayer;
+    replayer.add("x", rebuilt.x);
+    replayer.add("width", rebuilt.width);
+    replayer.add("name", rebuilt.name);
+    auto report = replayer.replay(loaded);
+    EXPECT_EQ(report.events.size(), 3u);
+    EXPECT_EQ(report.skipped, 1u);
+    EXPECT_EQ(rebuilt.x.value(), 5);
+    EXPECT_EQ(rebuilt.right.value(), 105);
+    EXPECT_TRUE(rebuilt.wide.value());
+    EXPECT_EQ(rebuilt.name.value(), "button");
+    EXPECT_GE(report.percentile(0.99), report.percentile(0.5));
+}
+
+TEST(Recorder, ringOverwritesOldest) {
+    property<int> a = 0;
+    ChangeRecorder recorder(4);
+    recorder.track("a", a);
+    recorder.start();
+    for(int i = 1; i <= 10; ++i)
+        a = i;
+    recorder.stop();
+
+    auto events = recorder.events();
+    ASSERT_EQ(events.size(), 4u);
+    EXPECT_EQ(recorder.dropped(), 6u);
+    int first = 0;
+    std::memcpy(&first, events.front().payload, sizeof(int));
+    EXPECT_EQ(first, 7);
+}
+
+TEST(Recorder, stopAndDestroyInAnyOrder) {
+    property<int> a = 0;
+    ChangeRecorder outer;
+    outer.track("a", a);
+    {
+        ChangeRecorder inner;
+        inner.track("a", a);
+        inner.start();
+        outer.start();
+        outer.start(); // already started
+        inner.stop();  // not the latest, still taken out
+        EXPECT_EQ(PropertyTracer::current(), &outer);
+        a = 1;
+        EXPECT_EQ(inner.events().size(), 0u);
+        EXPECT_EQ(outer.events().size(), 1u);
+
+        inner.start();
+        a = 2;
+        EXPECT_EQ(inner.events().size(), 1u);
+        EXPECT_EQ(outer.events().size(), 2u);
+        outer.stop();
+        inner.start();
+    } // inner is destroyed while installed
+    EXPECT_EQ(PropertyTracer::current(), nullptr);
+    a = 3;
+
+    // destroyed while installed behind a later tracer
+    outer.start();
+    {
+        ChangeRecorder inner;
+        inner.start();
+        outer.stop();
+        outer.start();
+    }
+    EXPECT_EQ(PropertyTracer::current(), &outer);
+    a = 4;
+    EXPECT_EQ(outer.events().size(), 3u);
+    outer.stop();
+}
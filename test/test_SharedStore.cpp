@@ -0,0 +1,142 @@
+#include "gtest/gtest.h"
+#include "../src/SharedStore.hpp"
+
+#if defined(__linux__)
+
+#include <sys/wait.h>
+#include <thread>
+
+namespace {
+
+struct Pair {
+    int a;
+    int b; // always -a
+};
+
+std::string storeName(const char* test) {
+    return "/pb_" + std::string(test) + "_" + std::to_string(getpid());
+}
+
+} // namespace
+
+TEST(SharedStore, readAcrossProcesses) {
+    std::string name = storeName("proc");
+    property<int> width = 10;
+    property<double> scale = 1.5;
+    property<int> area = width * 2;
+
+    SharedPropertyStore store(name);
+    ASSERT_TRUE(store);
+    EXPECT_EQ(store.publish("width", width), 0);
+    EXPECT_EQ(store.publish("scale", scale), 1);
+    EXPECT_EQ(store.publish("area", area), 2);
+
+    int ready[2], go[2];
+    ASSERT_EQ(pipe(ready), 0);
+    ASSERT_EQ(pipe(go), 0);
+
+    pid_t pid = fork();
+    ASSERT_GE(pid, 0);
+    if(pid == 0) {
+        // child: never return into gtest, report through the exit code
+        char c = 0;
+        SharedStoreView view(name);
+        property<int> mirror = 0;
+        if(!view || view.read<int>("width") != 10 || view.read<double>("scale") != 1.5 || !view.mirror("area", mirror) ||
+           mirror.value() != 20 || view.read<double>("width") || view.find("missing") != -1)
+            _exit(1);
+        uint64_t seen = view.epoch();
+        if(write(ready[1], &c, 1) != 1 || read(go[0], &c, 1) != 1)
+            _exit(2);
+        std::vector<int> changed;
+        view.forEachChanged(seen, [&changed](int i) { changed.push_back(i); });
+        if(changed != std::vector<int>{0, 2} || view.read<int>(0) != 50 || view.poll() != 1 || mirror.value() != 100)
+            _exit(3);
+        _exit(0);
+    }
+
+    char c = 0;
+    ASSERT_EQ(read(ready[0], &c, 1), 1);
+    width = 50;
+    ASSERT_EQ(write(go[1], &c, 1), 1);
+    int status = 0;
+    ASSERT_EQ(waitpid(pid, &status, 0), pid);
+    ASSERT_TRUE(WIFEXITED(status));
+    EXPECT_EQ(WEXITSTATUS(status), 0);
+    for(int fd : {ready[0], ready[1], go[0], go[1]})
+        close(fd);
+}
+
+TEST(SharedStore, readsAreNeverTorn) {
+    std::string name = storeName("torn");
+    property<Pair> pair = Pair{0, 0};
+    SharedPropertyStore store(name, 4);
+    ASSERT_EQ(store.publish("pair", pair), 0);
+    SharedStoreView view(name);
+    ASSERT_TRUE(view);
+
+    std::atomic<bool> done = false;
+    std::thread writer([&] {
+        for(int i = 1; i <= 200000; ++i)
+            pair = Pair{i, -i};
+        done = true;
+    });
+    size_t torn = 0, reads = 0;
+    while(!done) {
+        if(auto p = view.read<Pair>(0)) {
+            torn += p->a != -p->b;
+            ++reads;
+        }
+    }
+    writer.join();
+    EXPECT_EQ(torn, 0u);
+    EXPECT_GT(reads, 0u);
+    EXPECT_EQ(view.read<Pair>(0)->a, 200000);
+}
+
+TEST(SharedStore, readsGiveUpOnStuckSlot) {
+    // A writer that dies between the two halves of a seqlock store.
+    struct StuckStore : SharedPropertyStore {
+        using SharedPropertyStore::SharedPropertyStore;
+        void beginWrite(int i) { slot(static_cast<size_t>(i))->seq.fetch_add(1); }
+        void endWrite(int i) { slot(static_cast<size_t>(i))->seq.fetch_add(1); }
+    };
+    std::string name = storeName("stuck");
+    property<int> a = 7;
+    StuckStore store(name, 4);
+    ASSERT_EQ(store.publish("a", a), 0);
+    SharedStoreView view(name);
+    ASSERT_TRUE(view);
+
+    store.beginWrite(0);
+    EXPECT_FALSE(view.read<int>(0));
+    store.endWrite(0);
+    EXPECT_EQ(view.read<int>(0), 7);
+
+    // indices outside the published slots
+    for(int i : {-1, 1, 3, 4}) {
+        EXPECT_FALSE(view.read<int>(i)) << i;
+        EXPECT_EQ(view.version(i), 0u) << i;
+    }
+    EXPECT_GT(view.version(0), 0u);
+}
+
+TEST(SharedStore, storeDisconnectsWhenDestroyed) {
+    property<int> a = 1;
+    auto before = PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers];
+    {
+        SharedPropertyStore store(storeName("disconnect"), 4);
+        ASSERT_EQ(store.publish("a", a), 0);
+        EXPECT_EQ(PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers], before + 1);
+    }
+    EXPECT_EQ(PropertyMetrics::snapshot().gauges[PropertyMetrics::Observers], before);
+    a = 2;
+}
+
+TEST(SharedStore, rejectsMissingStore) {
+    SharedStoreView view("/pb_does_not_exist");
+    EXPECT_FALSE(view);
+    EXPECT_FALSE(view.read<int>("x"));
+}
+
+#endif
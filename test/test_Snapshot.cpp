@@ -0,0 +1,104 @@
+#include "gtest/gtest.h"
+#include <cstdio>
+#include <cstring>
+#include <string>
+#include "../src/Snapshot.hpp"
+
+TEST(Snapshot, restore) {
+    property<int> width = 10;
+    property<int> height = 20;
+    property<std::string> title = "main";
+    property<int> area = width * height;
+
+    PropertySnapshot snapshot;
+    snapshot.add("width", width);
+    snapshot.add("height", height);
+    snapshot.add("title", title);
+    snapshot.add("area", area);
+    auto image = snapshot.save();
+
+    int fired = 0;
+    area.onValueChanged([&fired] { ++fired; });
+
+    width = 1;
+    height = 2;
+    title = std::string("other");
+    EXPECT_EQ(area.value(), 2);
+    fired = 0;
+
+    ASSERT_TRUE(snapshot.restore(image));
+    EXPECT_EQ(width.value(), 10);
+    EXPECT_EQ(height.value(), 20);
+    EXPECT_EQ(title.value(), "main");
+    EXPECT_EQ(area.value(), 200);
+    EXPECT_TRUE(area.isBound());
+    EXPECT_EQ(fired, 1);
+}
+
+TEST(Snapshot, rejectsBadImage) {
+    property<int> a = 1;
+    PropertySnapshot snapshot;
+    snapshot.add("a", a);
+    auto image = snapshot.save();
+    a = 2;
+
+    auto truncated = image;
+    truncated.resize(truncated.size() - 9);
+    EXPECT_FALSE(snapshot.restore(truncated));
+    auto corrupt = image;
+    corrupt[0] = std::byte{'X'};
+    EXPECT_FALSE(snapshot.restore(corrupt));
+    EXPECT_EQ(a.value(), 2);
+
+    PropertySnapshot other;
+    property<int> b = 3;
+    other.add("b", b);
+    EXPECT_TRUE(other.restore(image));
+    EXPECT_EQ(b.value(), 3);
+}
+
+TEST(Snapshot, rejectedImageTouchesNothing) {
+    property<int> a = 1;
+    property<int> b = 2;
+    PropertySnapshot snapshot;
+    snapshot.add("a", a);
+    snapshot.add("b", b);
+    auto image = snapshot.save();
+    a = 10;
+    b = 20;
+
+    // The first entry is valid; the second has a size its codec refuses.
+    SnapshotEntry second;
+    std::memcpy(&second, image.data() + sizeof(SnapshotHeader) + sizeof(SnapshotEntry), sizeof(second));
+    second.size = 3;
+    std::memcpy(image.data() + sizeof(SnapshotHeader) + sizeof(SnapshotEntry), &second, sizeof(second));
+    EXPECT_FALSE(snapshot.restore(image));
+    EXPECT_EQ(a.value(), 10);
+    EXPECT_EQ(b.value(), 20);
+}
+
+TEST(Snapshot, rejectsDuplicateKey) {
+    property<int> a = 1;
+    property<int> other = 2;
+    PropertySnapshot snapshot;
+    EXPECT_TRUE(snapshot.add("a", a));
+    EXPECT_FALSE(snapshot.add("a", other));
+    EXPECT_EQ(snapshot.size(), 1u);
+    auto image = snapshot.save();
+    a = 5;
+    ASSERT_TRUE(snapshot.restore(image));
+    EXPECT_EQ(a.value(), 1);
+    EXPECT_EQ(other.value(), 2);
+}
+
+TEST(Snapshot, file) {
+    property<double> scale = 1.5;
+    PropertySnapshot snapshot;
+    snapshot.add("scale", scale);
+    std::string path = ::testing::TempDir() + "property_snapshot.bin";
+    ASSERT_TRUE(snapshot.saveToFile(path));
+    scale = 3.0;
+    ASSERT_TRUE(snapshot.restoreFromFile(path));
+    EXPECT_EQ(scale.value(), 1.5);
+    std::remove(path.c_str());
+}
@@ -0,0 +1,103 @@
+#include "gtest/gtest.h"
+#include "../src/StaticSchedule.hpp"
+
+namespace {
+
+struct Box {
+    int x = 0;
+    int y = 0;
+    int width = 0;
+    int height = 0;
+    int right = 0;
+    int bottom = 0;
+    int center = 0;
+    double ratio = 0;
+};
+
+int s_evaluations = 0;
+
+// Declared out of dependency order on purpose.
+using BoxSchedule = StaticSchedule<Box,
+    Rule<&Box::center, [](int x, int right) { ++s_evaluations; return (x + right) / 2; }, &Box::x, &Box::right>,
+    Rule<&Box::right, [](int x, int w) { ++s_evaluations; return x + w; }, &Box::x, &Box::width>,
+    Rule<&Box::bottom, [](int y, int h) { ++s_evaluations; return y + h; }, &Box::y, &Box::height>,
+    Rule<&Box::ratio, [](int w, int h) { ++s_evaluations; return h ? double(w) / h : 0.0; }, &Box::width, &Box::height>>;
+
+static_assert(BoxSchedule::order == std::array<size_t, 4>{1, 2, 3, 0});
+static_assert(BoxSchedule::downstream<&Box::y>() == std::array<bool, 4>{false, false, true, false});
+static_assert(BoxSchedule::downstream<&Box::width>() == std::array<bool, 4>{true, true, false, true});
+
+} // namespace
+
+TEST(StaticSchedule, update) {
+    Box box{.x = 10, .y = 20, .width = 100, .height = 50};
+    BoxSchedule::update(box);
+    EXPECT_EQ(box.right, 110);
+    EXPECT_EQ(box.bottom, 70);
+    EXPECT_EQ(box.center, 60);
+    EXPECT_DOUBLE_EQ(box.ratio, 2.0);
+
+    s_evaluations = 0;
+    box.y = 0;
+    BoxSchedule::changed<&Box::y>(box);
+    EXPECT_EQ(box.bottom, 50);
+    EXPECT_EQ(s_evaluations, 1);
+
+    s_evaluations = 0;
+    box.x = 0;
+    box.height = 100;
+    BoxSchedule::changed<&Box::x, &Box::height>(box);
+    EXPECT_EQ(box.right, 100);
+    EXPECT_EQ(box.center, 50);
+    EXPECT_EQ(box.bottom, 100);
+    EXPECT_DOUBLE_EQ(box.ratio, 1.0);
+    EXPECT_EQ(s_evaluations, 4);
+}
+
+TEST(StaticSchedule, object) {
+    StaticObject<BoxSchedule> box(Box{.width = 10, .height = 10});
+    EXPECT_EQ(box.get<&Box::right>(), 10);
+
+    int notified = 0;
+    box.onValueChanged([&] { ++notified; });
+    box.set<&Box::x>(5);
+    EXPECT_EQ(box.get<&Box::right>(), 15);
+    EXPECT_EQ(box.get<&Box::center>(), 10);
+    EXPECT_EQ(notified, 1);
+
+    box.modify<&Box::width, &Box::height>([](Box& b) {
+        b.width = 20;
+        b.height = 40;
+    });
+    EXPECT_EQ(box.get<&Box::right>(), 25);
+    EXPECT_EQ(box.get<&Box::bottom>(), 40);
+    EXPECT_DOUBLE_EQ(box.get<&Box::ratio>(), 0.5);
+    EXPECT_EQ(notified, 2);
+}
+
+TEST(StaticSchedule, crossObjectEdges) {
+    property<int> left = 3;
+    StaticObject<BoxSchedule> box(Box{.width = 10});
+    box.bind<&Box::x>(left);
+    EXPECT_EQ(box.get<&Box::right>(), 13);
+
+    // Only the exported field takes part in the dynamic graph.
+    property<int> next = box.output<&Box::right>() + 1;
+    EXPECT_EQ(&box.output<&Box::right>(), &box.output<&Box::right>());
+    EXPECT_EQ(next.value(), 14);
+    int changes = 0;
+    next.onValueChanged([&] { ++changes; });
+
+    left = 7;
+    EXPECT_EQ(box.get<&Box::right>(), 17);
+    EXPECT_EQ(next.value(), 18);
+    EXPECT_EQ(changes, 1);
+
+    box.set<&Box::y>(4); // right does not move
+    EXPECT_EQ(changes, 1);
+
+    property<int> area = computed([&] { return box.value().width * box.value().height; });
+    EXPECT_EQ(area.value(), 0);
+    box.set<&Box::height>(5);
+    EXPECT_EQ(area.value(), 50);
+}
@@ -0,0 +1,86 @@
+#include "gtest/gtest.h"
+#include <vector>
+#include "../src/TimeOperators.hpp"
+
+using namespace std::chrono_literals;
+
+TEST(TimeOperators, debounce) {
+    ManualClock clock;
+    property<int> mouse = 0;
+    auto quiet = debounce(mouse, 100ms, clock);
+    property<int> doubled = quiet.output() * 2;
+    std::vector<int> seen;
+    quiet.output().onValueChanged([&seen](int v) { seen.push_back(v); });
+
+    for(int i = 1; i <= 5; ++i) {
+        mouse = i;
+        clock.advance(50ms);
+    }
+    EXPECT_TRUE(seen.empty());
+    clock.advance(50ms);
+    EXPECT_EQ(seen, std::vector<int>{5});
+    EXPECT_EQ(doubled.value(), 10);
+    clock.advance(1s);
+    EXPECT_EQ(seen.size(), 1u);
+}
+
+TEST(TimeOperators, throttle) {
+    ManualClock clock;
+    property<int> sensor = 0;
+    auto slow = throttle(sensor, 100ms, clock);
+    std::vector<int> seen;
+    slow.output().onValueChanged([&seen](int v) { seen.push_back(v); });
+
+    sensor = 1; // leading edge
+    clock.advance(10ms);
+    sensor = 2;
+    clock.advance(10ms);
+    sensor = 3;
+    EXPECT_EQ(seen, std::vector<int>{1});
+    clock.advance(80ms); // trailing edge at 100ms
+    EXPECT_EQ(seen, (std::vector<int>{1, 3}));
+    clock.advance(150ms);
+    sensor = 4; // interval elapsed, immediate again
+    EXPECT_EQ(seen, (std::vector<int>{1, 3, 4}));
+}
+
+TEST(TimeOperators, sample) {
+    ManualClock clock;
+    property<int> source = 0;
+    std::vector<int> seen;
+    {
+        auto sampled = sample(source, 16ms, clock);
+        sampled.output().onValueChanged([&seen](int v) { seen.push_back(v); });
+        source = 1;
+        source = 2;
+        clock.advance(16ms);
+        clock.advance(16ms); // unchanged, nothing emitted
+        source = 3;
+        clock.advance(20ms);
+        EXPECT_EQ(seen, (std::vector<int>{2, 3}));
+    }
+    EXPECT_FALSE(clock.nextDeadline().has_value());
+    source = 4;
+    clock.advance(1s);
+    EXPECT_EQ(seen.size(), 2u);
+}
+
+TEST(TimeOperators, outlivesSource) {
+    ManualClock clock;
+    auto source = std::make_unique<property<int>>(1);
+    auto quiet = debounce(*source, 10ms, clock);
+    *source = 2;
+    source.reset();
+    clock.advance(10ms);
+    EXPECT_EQ(quiet.value(), 2);
+}
+
+TEST(TimeOperators, chained) {
+    ManualClock clock;
+    property<int> source = 0;
+    auto quiet = debounce(source, 10ms, clock);
+    auto slow = throttle(quiet.output(), 100ms, clock);
+    source = 1;
+    clock.advance(10ms);
+    EXPECT_EQ(slow.value(), 1);
+}